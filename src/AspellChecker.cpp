@@ -429,7 +429,7 @@ AspellChecker::~AspellChecker()
 
 
 SpellChecker::Result AspellChecker::check(WordLangTuple const & word,
-					  vector<WordLangTuple> const & docdict)
+					  WordLangTable const & docdict)
 {
 	AspellSpeller * m = d->speller(word.lang());
 
@@ -440,15 +440,17 @@ SpellChecker::Result AspellChecker::check(WordLangTuple const & word,
 		// MSVC compiled Aspell doesn't like it.
 		return WORD_OK;
 
-	vector<WordLangTuple>::const_iterator it = docdict.begin();
-	for (; it != docdict.end(); ++it) {
-		if (it->lang()->code() != word.lang()->code())
-			continue;
-		if (it->word() == word.word())
-			return DOCUMENT_LEARNED_WORD;
-	}
-	SpellChecker::Result rc = d->check(m, word);
-	return (rc == WORD_OK && d->learned(word)) ? LEARNED_WORD : rc;
+	if (docdict.contains(word))
+		return DOCUMENT_LEARNED_WORD;
+
+	SpellChecker::Result rc;
+	if (cachedResult(word, rc))
+		return rc;
+	rc = d->check(m, word);
+	if (rc == WORD_OK && d->learned(word))
+		rc = LEARNED_WORD;
+	cacheResult(word, rc);
+	return rc;
 }
 
 
@@ -0,0 +1,284 @@
+/**
+ * \file BibFileCache.cpp
+ * This file is part of LyX, the document processor.
+ * Licence details can be found in the file COPYING.
+ *
+ * Full author contact details are available in file CREDITS.
+ */
+
+#include <config.h>
+
+#include "BibFileCache.h"
+
+#include "BiblioInfo.h"
+
+#include "support/binaryio.h"
+#include "support/checksum.h"
+#include "support/debug.h"
+#include "support/docstring.h"
+#include "support/FileName.h"
+#include "support/FileNameList.h"
+#include "support/filetools.h"
+#include "support/mutex.h"
+#include "support/Package.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+using namespace lyx::support;
+
+namespace lyx {
+
+namespace {
+
+/// Identifies the format of the cache files, change on format changes
+string const cache_magic = "LyXBibCache 1";
+
+
+class CacheItem {
+public:
+	CacheItem() : timestamp(0), checksum(0) {}
+	///
+	time_t timestamp;
+	///
+	unsigned long checksum;
+	///
+	BiblioInfo info;
+};
+
+
+/// The maximal number of files in the cache directory
+size_t const max_cache_files = 200;
+
+} // namespace
+
+
+class BibFileCache::Impl {
+public:
+	///
+	FileName cacheDir() const;
+	///
+	FileName cacheFile(string const & key) const;
+	///
+	bool read(string const & key, CacheItem & item) const;
+	///
+	void write(string const & key, CacheItem const & item) const;
+	/// Remove the oldest files if there are too many in the cache directory
+	void prune() const;
+
+	///
+	typedef map<string, CacheItem> CacheType;
+	///
+	CacheType cache;
+	///
+	Mutex mutex;
+	/// Has the cache directory been pruned in this session?
+	mutable bool pruned = false;
+};
+
+
+FileName BibFileCache::Impl::cacheDir() const
+{
+	return FileName(addPath(package().user_support().absFileName(), "bibcache"));
+}
+
+
+FileName BibFileCache::Impl::cacheFile(string const & key) const
+{
+	ostringstream os;
+	os << setw(10) << setfill('0') << support::checksum(key) << ".bib";
+	return FileName(addName(cacheDir().absFileName(), os.str()));
+}
+
+
+bool BibFileCache::Impl::read(string const & key, CacheItem & item) const
+{
+	FileName const file = cacheFile(key);
+	if (!file.isReadableFile())
+		return false;
+	ifstream is(file.toFilesystemEncoding().c_str(), ios::binary);
+	string magic;
+	string stored_key;
+	uint64_t timestamp;
+	uint64_t checksum;
+	if (!readString(is, magic) || magic != cache_magic
+	    || !readString(is, stored_key) || stored_key != key
+	    || !readNumber(is, timestamp) || !readNumber(is, checksum))
+		return false;
+
+	BiblioInfo info;
+	uint64_t n;
+	docstring s;
+	if (!readNumber(is, n))
+		return false;
+	for (uint64_t i = 0; i < n; ++i) {
+		if (!readString(is, s))
+			return false;
+		info.addFieldName(s);
+	}
+	if (!readNumber(is, n))
+		return false;
+	for (uint64_t i = 0; i < n; ++i) {
+		if (!readString(is, s))
+			return false;
+		info.addEntryType(s);
+	}
+	if (!readNumber(is, n))
+		return false;
+	for (uint64_t i = 0; i < n; ++i) {
+		docstring bibkey;
+		docstring type;
+		docstring data;
+		uint64_t nfields;
+		if (!readString(is, bibkey) || !readString(is, type)
+		    || !readString(is, data) || !readNumber(is, nfields))
+			return false;
+		BibTeXInfo entry(bibkey, type);
+		for (uint64_t j = 0; j < nfields; ++j) {
+			docstring name;
+			if (!readString(is, name) || !readString(is, entry[name]))
+				return false;
+		}
+		entry.setAllData(data);
+		info[bibkey] = entry;
+	}
+
+	item.timestamp = time_t(timestamp);
+	item.checksum = checksum;
+	item.info = info;
+	LYXERR(Debug::FILES, "Read bib cache file " << file << " for " << key);
+	return true;
+}
+
+
+void BibFileCache::Impl::write(string const & key, CacheItem const & item) const
+{
+	FileName const file = cacheFile(key);
+	if (!file.onlyPath().createPath()) {
+		LYXERR(Debug::FILES, "Cannot create bib cache directory for " << file);
+		return;
+	}
+	ostringstream os;
+	writeString(os, cache_magic);
+	writeString(os, key);
+	writeNumber(os, item.timestamp);
+	writeNumber(os, item.checksum);
+	writeStrings(os, item.info.getFields());
+	writeStrings(os, item.info.getEntries());
+	BiblioInfo const & info = item.info;
+	writeNumber(os, distance(info.begin(), info.end()));
+	for (auto const & kv : info) {
+		BibTeXInfo const & entry = kv.second;
+		writeString(os, kv.first);
+		writeString(os, entry.entryType());
+		writeString(os, entry.allData());
+		writeNumber(os, distance(entry.begin(), entry.end()));
+		for (auto const & field : entry) {
+			writeString(os, field.first);
+			writeString(os, field.second);
+		}
+	}
+	if (!replaceFile(file, os.str()))
+		LYXERR(Debug::FILES, "Could not write bib cache file " << file);
+	prune();
+}
+
+
+void BibFileCache::Impl::prune() const
+{
+	// Once per session is enough
+	if (pruned)
+		return;
+	pruned = true;
+	FileNameList files = cacheDir().dirList("bib");
+	if (files.size() <= max_cache_files)
+		return;
+	// Keep the files that have been written last
+	sort(files.begin(), files.end(),
+	     [](FileName const & a, FileName const & b) {
+		return a.lastModified() > b.lastModified();
+	});
+	for (size_t i = max_cache_files; i < files.size(); ++i) {
+		LYXERR(Debug::FILES, "Removing bib cache file " << files[i]);
+		files[i].removeFile();
+	}
+}
+
+
+BibFileCache::BibFileCache()
+	: pimpl_(new Impl)
+{}
+
+
+BibFileCache::~BibFileCache()
+{
+	delete pimpl_;
+}
+
+
+BibFileCache & BibFileCache::get()
+{
+	// Now return the cache
+	static BibFileCache singleton;
+	return singleton;
+}
+
+
+namespace {
+
+string const cacheKey(FileName const & bibfile, string const & encoding)
+{
+	return bibfile.absFileName() + '\n' + encoding;
+}
+
+} // namespace
+
+
+bool BibFileCache::find(FileName const & bibfile, string const & encoding,
+			BiblioInfo & info) const
+{
+	string const key = cacheKey(bibfile, encoding);
+	Mutex::Locker lock(&pimpl_->mutex);
+	Impl::CacheType::iterator it = pimpl_->cache.find(key);
+	if (it == pimpl_->cache.end()) {
+		CacheItem item;
+		if (!pimpl_->read(key, item))
+			return false;
+		it = pimpl_->cache.insert(make_pair(key, item)).first;
+	}
+	CacheItem & item = it->second;
+	time_t const timestamp = bibfile.lastModified();
+	if (item.timestamp != timestamp) {
+		if (item.checksum != bibfile.checksum()) {
+			LYXERR(Debug::FILES, "Bib cache item for " << bibfile
+					     << " is out of date.");
+			return false;
+		}
+		// Only the timestamp changed
+		item.timestamp = timestamp;
+	}
+	info = item.info;
+	return true;
+}
+
+
+void BibFileCache::add(FileName const & bibfile, string const & encoding,
+		       BiblioInfo const & info) const
+{
+	string const key = cacheKey(bibfile, encoding);
+	CacheItem item;
+	item.timestamp = bibfile.lastModified();
+	item.checksum = bibfile.checksum();
+	item.info = info;
+	Mutex::Locker lock(&pimpl_->mutex);
+	pimpl_->write(key, item);
+	pimpl_->cache[key] = item;
+}
+
+} // namespace lyx
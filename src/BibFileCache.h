@@ -0,0 +1,78 @@
+// -*- C++ -*-
+/**
+ * \file BibFileCache.h
+ * This file is part of LyX, the document processor.
+ * Licence details can be found in the file COPYING.
+ *
+ * Full author contact details are available in file CREDITS.
+ *
+ * BibFileCache keeps the parsed contents of BibTeX databases.
+ *
+ * BibFileCache is a singleton class. It is possible to have
+ * only one instance of it at any moment.
+ */
+
+#ifndef BIBFILECACHE_H
+#define BIBFILECACHE_H
+
+#include "support/strfwd.h"
+
+
+namespace lyx {
+
+class BiblioInfo;
+
+namespace support { class FileName; }
+
+/**
+ * Cache for parsed BibTeX databases. The cache works as follows:
+ *
+ * The key for a cache item consists of the absolute name of the database
+ * and the iconv name of the encoding it is read with. A cache item is
+ * considered up to date if the stored timestamp of the item is identical
+ * with the actual timestamp of the database, or, if that is not the case,
+ * the stored checksum is identical with the actual checksum of the
+ * database.
+ *
+ * Items are kept in memory for the whole session. They are also written
+ * to the "bibcache" directory of the user directory, so that unchanged
+ * databases need not be parsed again in later sessions. The oldest files
+ * of that directory are removed if it holds too many of them.
+ */
+class BibFileCache {
+public:
+	/// This is a singleton class. Get the instance.
+	static BibFileCache & get();
+
+	/**
+	 * Set \p info to the cached contents of \p bibfile read with
+	 * \p encoding. Returns \c false if there is no up to date item.
+	 */
+	bool find(support::FileName const & bibfile,
+		  std::string const & encoding, BiblioInfo & info) const;
+
+	/// Add \p info, the contents of \p bibfile read with \p encoding.
+	void add(support::FileName const & bibfile,
+		 std::string const & encoding, BiblioInfo const & info) const;
+
+private:
+	/// noncopyable
+	BibFileCache(BibFileCache const &);
+	void operator=(BibFileCache const &);
+
+	/** Make the c-tor, d-tor private so we can control how many objects
+	 *  are instantiated.
+	 */
+	BibFileCache();
+	///
+	~BibFileCache();
+
+	/// Use the Pimpl idiom to hide the internals.
+	class Impl;
+	/// The pointer never changes although *pimpl_'s contents may.
+	Impl * const pimpl_;
+};
+
+} // namespace lyx
+
+#endif
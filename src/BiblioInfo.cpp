@@ -32,11 +32,14 @@
 #include "support/gettext.h"
 #include "support/lassert.h"
 #include "support/lstrings.h"
+#include "support/Messages.h"
 #include "support/textutils.h"
 
+#include <chrono>
 #include <map>
 #include <regex>
 #include <set>
+#include <sstream>
 
 using namespace std;
 using namespace lyx::support;
@@ -494,7 +497,8 @@ docstring processRichtext(docstring const & str, bool richtext)
 
 BibTeXInfo::BibTeXInfo(docstring const & key, docstring const & type)
 	: is_bibtex_(true), bib_key_(key), num_bib_key_(0), entry_type_(type),
-	  info_(), format_(), modifier_(0)
+	  info_(), format_(), modifier_(0), authors_cached_(false),
+	  year_cached_(false)
 {}
 
 
@@ -502,11 +506,26 @@ BibTeXInfo::BibTeXInfo(docstring const & key, docstring const & type)
 docstring const BibTeXInfo::getAuthorOrEditorList(Buffer const * buf,
 					  bool full, bool forceshort) const
 {
+	// The sorting of the cited entries asks for this very often,
+	// and parsing the names is expensive.
+	bool const cacheable = is_bibtex_ && !buf && !full && !forceshort;
+	// The list contains translated strings like "et al.", so it is
+	// only valid for the GUI language it was computed in.
+	if (cacheable && authors_cached_
+	    && authors_language_ == Messages::guiLanguage())
+		return authors_;
+
 	docstring author = operator[]("author");
 	if (author.empty())
 		author = operator[]("editor");
 
-	return getAuthorList(buf, author, full, forceshort);
+	docstring const list = getAuthorList(buf, author, full, forceshort);
+	if (cacheable) {
+		authors_ = list;
+		authors_language_ = Messages::guiLanguage();
+		authors_cached_ = true;
+	}
+	return list;
 }
 
 
@@ -619,26 +638,11 @@ docstring const BibTeXInfo::getAuthorList(Buffer const * buf,
 docstring const BibTeXInfo::getYear() const
 {
 	if (is_bibtex_) {
-		// first try legacy year field
-		docstring year = operator[]("year");
-		if (!year.empty())
-			return year;
-		// now try biblatex's date field
-		year = operator[]("date");
-		// Format is [-]YYYY-MM-DD*/[-]YYYY-MM-DD*
-		// We only want the years.
-		static regex const yreg("[-]?([\\d]{4}).*");
-		static regex const ereg(".*/[-]?([\\d]{4}).*");
-		smatch sm;
-		string const date = to_utf8(year);
-		if (!regex_match(date, sm, yreg))
-			// cannot parse year.
-			return docstring();
-		year = from_ascii(sm[1]);
-		// check for an endyear
-		if (regex_match(date, sm, ereg))
-			year += char_type(0x2013) + from_ascii(sm[1]);
-		return year;
+		if (!year_cached_) {
+			year_ = parseYear();
+			year_cached_ = true;
+		}
+		return year_;
 	}
 
 	docstring const opt = label();
@@ -656,6 +660,31 @@ docstring const BibTeXInfo::getYear() const
 }
 
 
+docstring const BibTeXInfo::parseYear() const
+{
+	// first try legacy year field
+	docstring year = operator[]("year");
+	if (!year.empty())
+		return year;
+	// now try biblatex's date field
+	year = operator[]("date");
+	// Format is [-]YYYY-MM-DD*/[-]YYYY-MM-DD*
+	// We only want the years.
+	static regex const yreg("[-]?([\\d]{4}).*");
+	static regex const ereg(".*/[-]?([\\d]{4}).*");
+	smatch sm;
+	string const date = to_utf8(year);
+	if (!regex_match(date, sm, yreg))
+		// cannot parse year.
+		return docstring();
+	year = from_ascii(sm[1]);
+	// check for an endyear
+	if (regex_match(date, sm, ereg))
+		year += char_type(0x2013) + from_ascii(sm[1]);
+	return year;
+}
+
+
 void BibTeXInfo::getLocators(docstring & doi, docstring & url, docstring & file) const
 {
 	if (is_bibtex_) {
@@ -1507,6 +1536,8 @@ BiblioInfo::CiteStringMap const BiblioInfo::getCiteStrings(
 void BiblioInfo::mergeBiblioInfo(BiblioInfo const & info)
 {
 	bimap_.insert(info.begin(), info.end());
+	// The labels of the new entries may have been computed differently
+	label_context_.clear();
 	field_names_.insert(info.field_names_.begin(), info.field_names_.end());
 	entry_types_.insert(info.entry_types_.begin(), info.entry_types_.end());
 }
@@ -1569,20 +1600,69 @@ void BiblioInfo::collectCitedEntries(Buffer const & buf)
 }
 
 
+namespace {
+
+/// The settings of \p buf that author-year labels depend on.
+/// This is the complete set of document settings, since the engine
+/// options, the modules and the local layout can all change the labels.
+string labelContext(Buffer const & buf)
+{
+	BufferParams const & bp = buf.params();
+	ostringstream os;
+	bp.writeFile(os, &buf);
+	// A reloaded layout gets a new document class, so that changes of
+	// the cite macros in layout files and modules are caught as well.
+	os << static_cast<void const *>(bp.documentClassPtr().get()) << '\n';
+	return os.str();
+}
+
+} // namespace
+
+
 void BiblioInfo::makeCitationLabels(Buffer const & buf)
 {
+	auto const start = chrono::steady_clock::now();
 	collectCitedEntries(buf);
 	CiteEngineType const engine_type = buf.params().citeEngineType();
 	bool const numbers = (engine_type & ENGINE_TYPE_NUMERICAL);
 
-	int keynumber = 0;
+	if (numbers) {
+		int keynumber = 0;
+		for (auto const & ce : cited_entries_) {
+			map<docstring, BibTeXInfo>::iterator const biit = bimap_.find(ce);
+			// this shouldn't happen, but...
+			if (biit == bimap_.end())
+				// ...fail gracefully, anyway.
+				continue;
+			BibTeXInfo & entry = biit->second;
+			entry.setCiteNumber(convert<docstring>(++keynumber));
+			entry.label(entry.citeNumber());
+		}
+		// the labels have been overwritten
+		label_context_.clear();
+		LYXERR(Debug::INFO, "makeCitationLabels: " << cited_entries_.size()
+		       << " entries in " << chrono::duration_cast<chrono::milliseconds>(
+			       chrono::steady_clock::now() - start).count() << " ms");
+		return;
+	}
+
+	// The labels computed by an earlier call are still valid if the
+	// settings they depend on did not change, and neither did the
+	// modifier of the entry, that is, its group of entries with the
+	// same authors and year.
+	string const context = labelContext(buf);
+	bool const relabel_all = context != label_context_;
+	label_context_ = context;
+
+	// add letters to years
+	// the entries and their new modifiers
+	vector<pair<BibTeXInfo *, char>> entries;
 	char modifier = 0;
 	// used to remember the last one we saw
 	// we'll be comparing entries to see if we need to add
 	// modifiers, like "1984a"
-	map<docstring, BibTeXInfo>::iterator last = bimap_.end();
-
-	// add letters to years
+	docstring last_authors;
+	docstring last_year;
 	for (auto const & ce : cited_entries_) {
 		map<docstring, BibTeXInfo>::iterator const biit = bimap_.find(ce);
 		// this shouldn't happen, but...
@@ -1590,55 +1670,52 @@ void BiblioInfo::makeCitationLabels(Buffer const & buf)
 			// ...fail gracefully, anyway.
 			continue;
 		BibTeXInfo & entry = biit->second;
-		if (numbers) {
-			docstring const num = convert<docstring>(++keynumber);
-			entry.setCiteNumber(num);
+		docstring const authors = entry.getAuthorOrEditorList();
+		// we access the year via getYear() so as to get it from the xref,
+		// if we need to do so
+		docstring const year = getYear(entry.key());
+		// The first test here is checking whether this is the first
+		// time through the loop. If so, then we do not have anything
+		// with which to compare.
+		if (!entries.empty() && authors == last_authors && year == last_year) {
+			if (modifier == 0) {
+				// so the last one should have been 'a'
+				entries.back().second = 'a';
+				modifier = 'b';
+			} else if (modifier == 'z')
+				modifier = 'A';
+			else
+				modifier++;
 		} else {
-			// The first test here is checking whether this is the first
-			// time through the loop. If so, then we do not have anything
-			// with which to compare.
-			if (last != bimap_.end()
-			    && entry.getAuthorOrEditorList() == last->second.getAuthorOrEditorList()
-			    // we access the year via getYear() so as to get it from the xref,
-			    // if we need to do so
-			    && getYear(entry.key()) == getYear(last->second.key())) {
-				if (modifier == 0) {
-					// so the last one should have been 'a'
-					last->second.setModifier('a');
-					modifier = 'b';
-				} else if (modifier == 'z')
-					modifier = 'A';
-				else
-					modifier++;
-			} else {
-				modifier = 0;
-			}
-			entry.setModifier(modifier);
-			// remember the last one
-			last = biit;
+			modifier = 0;
 		}
+		entries.push_back(make_pair(&entry, modifier));
+		last_authors = authors;
+		last_year = year;
 	}
+
 	// Set the labels
-	for (auto const & ce : cited_entries_) {
-		map<docstring, BibTeXInfo>::iterator const biit = bimap_.find(ce);
-		// this shouldn't happen, but...
-		if (biit == bimap_.end())
-			// ...fail gracefully, anyway.
+	size_t relabeled = 0;
+	for (auto const & e : entries) {
+		BibTeXInfo & entry = *e.first;
+		if (!relabel_all && !entry.label().empty()
+		    && entry.modifier() == e.second)
 			continue;
-		BibTeXInfo & entry = biit->second;
-		if (numbers) {
-			entry.label(entry.citeNumber());
-		} else {
-			docstring const auth = entry.getAuthorOrEditorList(&buf, false);
-			// we do it this way so as to access the xref, if necessary
-			// note that this also gives us the modifier
-			docstring const year = getYear(ce, buf, true);
-			if (!auth.empty() && !year.empty())
-				entry.label(auth + ' ' + year);
-			else
-				entry.label(entry.key());
-		}
+		entry.setModifier(e.second);
+		docstring const auth = entry.getAuthorOrEditorList(&buf, false);
+		// we do it this way so as to access the xref, if necessary
+		// note that this also gives us the modifier
+		docstring const year = getYear(entry.key(), buf, true);
+		if (!auth.empty() && !year.empty())
+			entry.label(auth + ' ' + year);
+		else
+			entry.label(entry.key());
+		++relabeled;
 	}
+	LYXERR(Debug::INFO, "makeCitationLabels: " << relabeled << " of "
+	       << entries.size() << " labels computed in "
+	       << chrono::duration_cast<chrono::milliseconds>(
+		       chrono::steady_clock::now() - start).count() << " ms");
 }
 
 
@@ -53,23 +53,26 @@ public:
 	///
 	typedef std::vector<BibTeXInfo const *> const BibTeXInfoList;
 	///
-	BibTeXInfo() : is_bibtex_(true), num_bib_key_(0), modifier_(0) {}
+	BibTeXInfo() : is_bibtex_(true), num_bib_key_(0), modifier_(0),
+		authors_cached_(false), year_cached_(false) {}
 	/// argument sets isBibTeX_, so should be false only if it's coming
 	/// from a bibliography environment
-	BibTeXInfo(bool ib) : is_bibtex_(ib), num_bib_key_(0), modifier_(0) {}
+	BibTeXInfo(bool ib) : is_bibtex_(ib), num_bib_key_(0), modifier_(0),
+		authors_cached_(false), year_cached_(false) {}
 	/// constructor that sets the entryType
 	BibTeXInfo(docstring const & key, docstring const & type);
 	/// \return an author or editor list (short form by default),
 	/// used for sorting.
 	/// This will be translated to the UI language if buf is null
 	/// otherwise, it will be translated to the buffer language.
+	/// The result for the default arguments is cached.
 	docstring const getAuthorOrEditorList(Buffer const * buf = nullptr,
 			bool full = false, bool forceshort = false) const;
 	/// Same for a specific author role (editor, author etc.)
 	docstring const getAuthorList(Buffer const * buf, docstring const & author,
 				      bool const full = false, bool const forceshort = false,
 				      bool const allnames = false, bool const beginning = true) const;
-	///
+	/// The result is cached for BibTeX entries.
 	docstring const getYear() const;
 	///
 	void getLocators(docstring & doi, docstring & url, docstring & file) const;
@@ -85,11 +88,13 @@ public:
 	///
 	const_iterator find(docstring const & f) const { return bimap_.find(f); }
 	///
+	const_iterator begin() const { return bimap_.begin(); }
+	///
 	const_iterator end() const { return bimap_.end(); }
 	/// \return value for field f
 	/// note that this will create an empty field if it does not exist
 	docstring & operator[](docstring const & f)
-		{ return bimap_[f]; }
+		{ authors_cached_ = year_cached_ = false; return bimap_[f]; }
 	/// \return value for field f
 	/// this one, since it is const, will simply return docstring() if
 	/// we don't have the field and will NOT create an empty field
@@ -131,6 +136,8 @@ private:
 	/// be the one referenced in the crossref or xdata field.
 	docstring getValueForKey(std::string const & key, Buffer const & buf,
 		CiteItem const & ci, BibTeXInfoList const & xrefs, size_t maxsize = 4096) const;
+	/// the year from the year or date field of a BibTeX entry
+	docstring const parseYear() const;
 	/// replace %keys% in a format string with their values
 	/// called from getInfo()
 	/// format strings may contain:
@@ -177,6 +184,17 @@ private:
 	char modifier_;
 	/// our map: <field, value>
 	std::map <docstring, docstring> bimap_;
+	/// a cache for getAuthorOrEditorList() with default arguments,
+	/// which is used for sorting
+	mutable docstring authors_;
+	/// the GUI language \c authors_ was computed in
+	mutable std::string authors_language_;
+	///
+	mutable bool authors_cached_;
+	/// a cache for getYear()
+	mutable docstring year_;
+	///
+	mutable bool year_cached_;
 };
 
 
@@ -262,7 +280,7 @@ public:
 	///
 	const_iterator begin() const { return bimap_.begin(); }
 	///
-	void clear() { bimap_.clear(); }
+	void clear() { bimap_.clear(); label_context_.clear(); }
 	///
 	bool empty() const { return bimap_.empty(); }
 	///
@@ -286,6 +304,9 @@ private:
 	std::set<docstring> entry_types_;
 	/// our map: keys --> BibTeXInfo
 	std::map<docstring, BibTeXInfo> bimap_;
+	/// The settings the author-year labels have been computed with
+	/// by makeCitationLabels(), empty if they are not known
+	std::string label_context_;
 	/// a possibly sorted list of entries cited in our Buffer.
 	/// do not try to make this a vector<BibTeXInfo *> or anything of
 	/// the sort, because reloads will invalidate those pointers.
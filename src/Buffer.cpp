@@ -21,8 +21,10 @@
 #include "BufferParams.h"
 #include "Bullet.h"
 #include "Chktex.h"
+#include "CiteEnginesList.h"
 #include "ColorSet.h"
 #include "Converter.h"
+#include "ConverterCache.h"
 #include "Counters.h"
 #include "Cursor.h"
 #include "CutAndPaste.h"
@@ -41,11 +43,13 @@
 #include "LaTeXFeatures.h"
 #include "LaTeX.h"
 #include "Layout.h"
+#include "LayoutFile.h"
 #include "Lexer.h"
 #include "LyXAction.h"
 #include "LyX.h"
 #include "LyXRC.h"
 #include "LyXVC.h"
+#include "ModuleList.h"
 #include "output.h"
 #include "output_latex.h"
 #include "output_docbook.h"
@@ -69,6 +73,8 @@
 #include "WordLangTuple.h"
 
 #include "insets/InsetBranch.h"
+#include "insets/InsetExternal.h"
+#include "insets/InsetGraphics.h"
 #include "insets/InsetInclude.h"
 #include "insets/InsetText.h"
 
@@ -85,6 +91,7 @@
 #include "frontends/WorkAreaManager.h"
 
 #include "support/lassert.h"
+#include "support/checksum.h"
 #include "support/convert.h"
 #include "support/debug.h"
 #include "support/docstring_list.h"
@@ -106,12 +113,14 @@
 #include "support/types.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <fstream>
 #include <iomanip>
 #include <map>
 #include <memory>
 #include <set>
 #include <sstream>
+#include <unordered_map>
 #include <vector>
 
 using namespace std;
@@ -207,11 +216,25 @@ public:
 		DocIterator scope;
 		MacroData macro;
 	};
-	typedef map<DocIterator, ScopeMacro> PositionScopeMacroMap;
-	typedef map<docstring, PositionScopeMacroMap> NamePositionScopeMacroMap;
-	/// map from the macro name to the position map,
-	/// which maps the macro definition position to the scope and the MacroData.
+	typedef pair<DocIterator, ScopeMacro> PositionScopeMacro;
+	/// sorted by the definition position
+	typedef vector<PositionScopeMacro> PositionScopeMacroList;
+	typedef unordered_map<docstring, PositionScopeMacroList, docstring_hash>
+		NamePositionScopeMacroMap;
+	/// map from the macro name to the list of its definitions, which pairs
+	/// the macro definition position with the scope and the MacroData.
+	/// This is looked up for every macro instance, hence the hashing.
 	NamePositionScopeMacroMap macros;
+	/// names of the macros that have been redefined since the last
+	/// call of updateMacroInstances()
+	MacroNameSet changed_macros;
+	/// Do all macro instances need to be resolved again?
+	bool all_macros_changed = true;
+	/// counts the calls of updateMacroInstances()
+	unsigned int macro_update_epoch = 0;
+	/// add the macros whose definitions use a changed macro to
+	/// changed_macros
+	void addDependentMacros();
 
 	/// positions of child buffers in the buffer
 	typedef map<Buffer const * const, DocIterator> BufferPositionMap;
@@ -3519,6 +3542,8 @@ void Buffer::setParent(Buffer const * buffer)
 
 	// We should be safe now.
 	d->setParent(buffer);
+	// The macro instances may point to macros of the old parent
+	d->all_macros_changed = true;
 	updateMacros();
 }
 
@@ -3645,25 +3670,24 @@ MacroData const * Buffer::Impl::getBufferMacro(docstring const & name,
 	// find macro definitions for name
 	NamePositionScopeMacroMap::const_iterator nameIt = macros.find(name);
 	if (nameIt != macros.end()) {
-		// find last definition in front of pos or at pos itself
-		PositionScopeMacroMap::const_iterator it
-			= greatest_below(nameIt->second, pos);
-		if (it != nameIt->second.end()) {
-			while (true) {
-				// scope ends behind pos?
-				if (pos < it->second.scope) {
-					// Looks good, remember this. If there
-					// is no external macro behind this,
-					// we found the right one already.
-					bestPos = it->first;
-					bestData = &it->second.macro;
-					break;
-				}
-
-				// try previous macro if there is one
-				if (it == nameIt->second.begin())
-					break;
-				--it;
+		PositionScopeMacroList const & defs = nameIt->second;
+		// find the definitions in front of pos
+		PositionScopeMacroList::const_iterator it = lower_bound(
+			defs.begin(), defs.end(), pos,
+			[](PositionScopeMacro const & def, DocIterator const & p) {
+				return def.first < p;
+			});
+		// try the last one first
+		while (it != defs.begin()) {
+			--it;
+			// scope ends behind pos?
+			if (pos < it->second.scope) {
+				// Looks good, remember this. If there
+				// is no external macro behind this,
+				// we found the right one already.
+				bestPos = it->first;
+				bestData = &it->second.macro;
+				break;
 			}
 		}
 	}
@@ -3849,8 +3873,10 @@ void Buffer::Impl::updateMacros(DocIterator & it, DocIterator & scope)
 			// register macro
 			// FIXME (Abdel), I don't understand why we pass 'it' here
 			// instead of 'macroTemplate' defined above... is this correct?
-			macros[macroTemplate.name()][it] =
-				Impl::ScopeMacro(scope, MacroData(owner_, it));
+			// The buffer is traversed in document order, so that
+			// the list of definitions stays sorted.
+			macros[macroTemplate.name()].push_back(make_pair(it,
+				Impl::ScopeMacro(scope, MacroData(owner_, it))));
 		}
 
 		// next paragraph
@@ -3867,8 +3893,12 @@ void Buffer::updateMacros() const
 
 	LYXERR(Debug::MACROS, "updateMacro of " << d->filename.onlyFileName());
 
+	// The parse of macro definitions depends on the known macros
+	MacroData::macrosChanged();
+
 	// start with empty table
-	d->macros.clear();
+	Impl::NamePositionScopeMacroMap old_macros;
+	old_macros.swap(d->macros);
 	d->children_positions.clear();
 	d->position_to_children.clear();
 
@@ -3880,6 +3910,67 @@ void Buffer::updateMacros() const
 	DocIterator outerScope = it;
 	outerScope.pit() = outerScope.lastpit() + 2;
 	d->updateMacros(it, outerScope);
+
+	// Keep the old definitions of the macros that did not change, since
+	// the macro instances point to them, and record the other names, so
+	// that updateMacroInstances() knows which instances to resolve.
+	// Definitions that were never queried cannot be compared, since
+	// their position may be stale, but no instance uses them either.
+	auto same = [](Impl::PositionScopeMacroList const & old_defs,
+		       Impl::PositionScopeMacroList const & new_defs) {
+		if (old_defs.size() != new_defs.size())
+			return false;
+		for (size_t i = 0; i < old_defs.size(); ++i) {
+			Impl::ScopeMacro const & o = old_defs[i].second;
+			Impl::ScopeMacro const & n = new_defs[i].second;
+			if (old_defs[i].first != new_defs[i].first
+			    || o.scope != n.scope || !o.macro.queried()
+			    || o.macro != n.macro)
+				return false;
+		}
+		return true;
+	};
+	for (auto & nameit : d->macros) {
+		auto const old_it = old_macros.find(nameit.first);
+		if (old_it != old_macros.end() && same(old_it->second, nameit.second))
+			nameit.second.swap(old_it->second);
+		else
+			d->changed_macros.insert(nameit.first);
+	}
+	for (auto const & nameit : old_macros)
+		if (d->macros.find(nameit.first) == d->macros.end())
+			d->changed_macros.insert(nameit.first);
+}
+
+
+void Buffer::Impl::addDependentMacros()
+{
+	// The expansion of a macro contains instances of the macros used
+	// in its definition, so it has to be updated when one of them is
+	// redefined. Looking for the names in the definitions is coarse,
+	// but errs on the safe side.
+	bool added = !changed_macros.empty();
+	while (added) {
+		added = false;
+		auto check = [&](docstring const & name, MacroData const & macro) {
+			if (changed_macros.count(name))
+				return;
+			for (docstring const & changed : changed_macros) {
+				docstring const cmd = from_ascii("\\") + changed;
+				if (contains(macro.definition(), cmd)
+				    || contains(macro.display(), cmd)) {
+					changed_macros.insert(name);
+					added = true;
+					return;
+				}
+			}
+		};
+		for (auto const & nameit : macros)
+			for (auto const & def : nameit.second)
+				check(nameit.first, def.second.macro);
+		for (auto const & nameit : MacroTable::globalMacros())
+			check(nameit.first, nameit.second);
+	}
 }
 
 
@@ -3914,6 +4005,19 @@ void Buffer::updateMacroInstances(UpdateType utype) const
 {
 	LYXERR(Debug::MACROS, "updateMacroInstances for "
 		<< d->filename.onlyFileName());
+	// Instances that have been resolved by the previous call only need
+	// to be resolved again if their macro has been redefined. We do not
+	// know when the macros of the parent or the children change, so
+	// resolve everything if they are involved.
+	bool const lazy = !d->all_macros_changed && !parent()
+		&& d->children_positions.empty();
+	if (lazy) {
+		d->addDependentMacros();
+		LYXERR(Debug::MACROS, d->changed_macros.size()
+		       << " macros changed since the last update");
+	}
+	unsigned int const epoch = ++d->macro_update_epoch;
+	MacroNameSet const * changed = lazy ? &d->changed_macros : nullptr;
 	DocIterator it = doc_iterator_begin(this);
 	it.forwardInset();
 	DocIterator const end = doc_iterator_end(this);
@@ -3928,9 +4032,13 @@ void Buffer::updateMacroInstances(UpdateType utype) const
 		MacroContext mc = MacroContext(this, it);
 		for (idx_type i = 0; i < n; ++i) {
 			MathData & data = minset->cell(i);
-			data.updateMacros(nullptr, mc, utype, 0);
+			data.updateMacros(nullptr, mc, utype, 0, epoch, changed);
 		}
 	}
+	d->changed_macros.clear();
+	// Instances resolved against a parent or a child may point to
+	// their macros, which can go away with them.
+	d->all_macros_changed = parent() || !d->children_positions.empty();
 }
 
 
@@ -4421,6 +4529,148 @@ void Buffer::setMathFlavor(OutputParams & op) const
 }
 
 
+namespace {
+
+/// Add the contents of the file \p fn to the export key in \p os
+void addFileToExportKey(ostream & os, FileName const & fn)
+{
+	os << fn.absFileName() << ' ';
+	if (fn.exists())
+		os << fn.checksum();
+	os << '\n';
+}
+
+
+/// Add the external files referenced by \p buf to the export key in \p os
+void addDependenciesToExportKey(ostream & os, Buffer const & buf)
+{
+	InsetIterator it = begin(buf.inset());
+	InsetIterator const itend = end(buf.inset());
+	for (; it != itend; ++it) {
+		switch (it->lyxCode()) {
+		case GRAPHICS_CODE: {
+			InsetGraphics const & ins =
+				static_cast<InsetGraphics const &>(*it);
+			addFileToExportKey(os, ins.params().filename);
+			break;
+		}
+		case EXTERNAL_CODE: {
+			InsetExternal const & ins =
+				static_cast<InsetExternal const &>(*it);
+			addFileToExportKey(os, ins.params().filename);
+			break;
+		}
+		case INCLUDE_CODE: {
+			// Child documents are serialized separately, but this
+			// also covers included plain (La)TeX and program files.
+			InsetInclude const & ins =
+				static_cast<InsetInclude const &>(*it);
+			addFileToExportKey(os,
+				makeAbsPath(ltrim(to_utf8(ins.getParam("filename"))),
+					    onlyPath(buf.absFileName())));
+			break;
+		}
+		default:
+			break;
+		}
+	}
+}
+
+
+/// Add the layout, module and cite engine files of \p buf to the export
+/// key in \p os. Files included by these with Input are not covered.
+void addLayoutToExportKey(ostream & os, Buffer const & buf)
+{
+	BufferParams const & bp = buf.params();
+	LayoutFile const * base = bp.baseClass();
+	if (base) {
+		// This is the lookup of TextClass::load()
+		FileName layout_file;
+		if (!base->path().empty())
+			layout_file = FileName(addName(base->path(),
+						       base->name() + ".layout"));
+		if (layout_file.empty() || !layout_file.exists())
+			layout_file = libFileSearch("layouts", base->name(), "layout");
+		addFileToExportKey(os, layout_file);
+	}
+	for (string const & mod : bp.getModules()) {
+		LyXModule const * const lm = theModuleList[mod];
+		if (lm)
+			addFileToExportKey(os,
+				libFileSearch("layouts", lm->getFilename()));
+	}
+	LyXCiteEngine const * const ce = theCiteEnginesList[bp.citeEngine()];
+	if (ce)
+		addFileToExportKey(os,
+			libFileSearch("citeengines", ce->getFilename()));
+}
+
+
+/// Add the preferences that change the exported files to the export key
+/// in \p os
+void addPreferencesToExportKey(ostream & os)
+{
+	os << lyxrc.bibtex_command << '\n'
+	   << lyxrc.jbibtex_command << '\n'
+	   << lyxrc.index_command << '\n'
+	   << lyxrc.jindex_command << '\n'
+	   << lyxrc.splitindex_command << '\n'
+	   << lyxrc.nomencl_command << '\n'
+	   << lyxrc.pygmentize_command << '\n'
+	   << lyxrc.plaintext_linelen << '\n'
+	   << lyxrc.language_custom_package << '\n'
+	   << lyxrc.language_auto_begin << ' '
+	   << lyxrc.language_auto_end << ' '
+	   << lyxrc.language_global_options << '\n'
+	   << lyxrc.language_command_begin << '\n'
+	   << lyxrc.language_command_end << '\n'
+	   << lyxrc.language_command_local << '\n'
+	   << lyxrc.default_decimal_sep << '\n'
+	   << lyxrc.windows_style_tex_paths << ' '
+	   << lyxrc.tex_allows_spaces << '\n'
+	   << lyxrc.path_prefix << '\n'
+	   << lyxrc.texinputs_prefix << '\n';
+}
+
+
+/** Compute the content key of an export of \p buf to \p format.
+ *  The key covers the serialized document and its children, all files
+ *  they reference, their layout files, the preferences that affect the
+ *  output and the converter chain \p path.
+ *  If any of these changes, the key changes too and a cached export is
+ *  not reused. Files that only LaTeX reads (packages, or files loaded
+ *  in ERT) are not known to LyX and thus not covered.
+ */
+uint64_t exportKey(Buffer const & buf, string const & backend_format,
+		string const & format, Graph::EdgePath const & path,
+		OutputParams const & runparams)
+{
+	ostringstream os;
+	os << backend_format << ' ' << format << ' '
+	   << runparams.includeall << '\n';
+	addPreferencesToExportKey(os);
+	for (int const edge : path) {
+		Converter const & conv = theConverters().get(edge);
+		os << conv.from() << ' ' << conv.to() << ' '
+		   << conv.command() << ' ' << conv.flags() << '\n';
+	}
+	buf.write(os);
+	addLayoutToExportKey(os, buf);
+	addDependenciesToExportKey(os, buf);
+	for (Buffer const * child : buf.getDescendants()) {
+		os << child->absFileName() << '\n';
+		child->write(os);
+		addLayoutToExportKey(os, *child);
+		addDependenciesToExportKey(os, *child);
+	}
+	for (docstring const & bf : buf.getBibfiles())
+		addFileToExportKey(os, buf.getBibfilePath(bf));
+	return support::checksum64(os.str());
+}
+
+} // namespace
+
+
 Buffer::ExportStatus Buffer::doExport(string const & target, bool put_in_tempdir,
 	bool includeall, string & result_file) const
 {
@@ -4446,10 +4696,10 @@ Buffer::ExportStatus Buffer::doExport(string const & target, bool put_in_tempdir
 	vector<string> backs = params().backends();
 	Converters converters = theConverters();
 	bool need_nice_file = false;
+	Graph::EdgePath path;
 	if (find(backs.begin(), backs.end(), format) == backs.end()) {
 		// Get the shortest path to format
 		converters.buildGraph();
-		Graph::EdgePath path;
 		for (string const & sit : backs) {
 			Graph::EdgePath p = converters.getPath(sit, format);
 			if (!p.empty() && (path.empty() || p.size() < path.size())) {
@@ -4498,9 +4748,37 @@ Buffer::ExportStatus Buffer::doExport(string const & target, bool put_in_tempdir
 	filename = changeExtension(filename,
 				   theFormats().extension(backend_format));
 	LYXERR(Debug::FILES, "filename=" << filename);
+	string const ext = theFormats().extension(format);
+	FileName const tmp_result_file(changeExtension(filename, ext));
+
+	// If the document, its children and all files they depend on did not
+	// change since the last export to this format, reuse that result.
+	bool const use_export_cache = !put_in_tempdir && !path.empty()
+		&& lyxrc.use_converter_cache && !isUnnamed() && fileName().exists();
+	uint64_t export_key = 0;
+	bool cached = false;
+	if (use_export_cache) {
+		export_key = exportKey(*this, backend_format, format, path, runparams);
+		cached = ConverterCache::get().copyExport(fileName(), format,
+							  export_key, tmp_result_file);
+	}
 
+	string const error_type = (format == "program")
+		? "Build" : params().bufferFormat();
+	if (cached) {
+		LYXERR(Debug::FILES, "Using cached export to " << format
+		       << " of " << fileName());
+		// Do not show the errors of the export that made the cache
+		// entry again, they have been reported then.
+		d->errorLists["Export"].clear();
+		d->errorLists[error_type].clear();
+		for (Buffer const * child : getDescendants()) {
+			child->d->errorLists["Export"].clear();
+			child->d->errorLists[error_type].clear();
+		}
+	}
 	// Plain text backend
-	if (backend_format == "text") {
+	else if (backend_format == "text") {
 		runparams.flavor = Flavor::Text;
 		try {
 			writePlaintextFile(*this, FileName(filename), runparams);
@@ -4553,12 +4831,8 @@ Buffer::ExportStatus Buffer::doExport(string const & target, bool put_in_tempdir
 			return ExportError;
 	}
 
-	string const error_type = (format == "program")
-		? "Build" : params().bufferFormat();
 	ErrorList & error_list = d->errorLists[error_type];
-	string const ext = theFormats().extension(format);
-	FileName const tmp_result_file(changeExtension(filename, ext));
-	Converters::RetVal const retval = 
+	Converters::RetVal const retval = cached ? Converters::SUCCESS :
 		converters.convert(this, FileName(filename), tmp_result_file,
 				   FileName(absFileName()), backend_format, format,
 				   error_list, Converters::none, includeall);
@@ -4617,6 +4891,12 @@ Buffer::ExportStatus Buffer::doExport(string const & target, bool put_in_tempdir
 	// if format == "dvi") to the result dir.
 	vector<ExportedFile> const extfiles =
 		runparams.exportdata->externalFiles(format);
+	// Results that need referenced files next to them cannot be
+	// restored from the cache alone.
+	if (use_export_cache && !cached && success && extfiles.empty()
+	    && tmp_result_file.exists())
+		ConverterCache::get().addExport(fileName(), format, export_key,
+						tmp_result_file);
 	string const dest = runparams.export_folder.empty() ?
 		onlyPath(result_file) : runparams.export_folder;
 	bool use_force = use_gui ? lyxrc.export_overwrite == ALL_FILES
@@ -5358,6 +5638,50 @@ bool Buffer::needUpdate() const
 }
 
 
+namespace {
+
+/// \return the end of the inset free text run that starts at \p dit.
+/// The run is bounded by the paragraph end, the next inset and \p end,
+/// if the latter lies in the same paragraph.
+pos_type textRunEnd(DocIterator const & dit, DocIterator const & end)
+{
+	pos_type run_end = dit.lastpos();
+	for (auto const & elem : dit.paragraph().insetList())
+		if (elem.pos >= dit.pos()) {
+			run_end = elem.pos;
+			break;
+		}
+	size_t const d = dit.depth() - 1;
+	if (end.depth() > d) {
+		CursorSlice const & ds = dit[d];
+		CursorSlice const & es = end[d];
+		if (&es.inset() == &ds.inset() && es.idx() == ds.idx()
+		    && es.pit() == ds.pit() && es.pos() >= ds.pos())
+			run_end = min(run_end, es.pos());
+	}
+	return run_end;
+}
+
+
+/// \return the number of words that start in [\p from, \p to) of \p par.
+int countWordStarts(Paragraph const & par, pos_type from, pos_type to)
+{
+	int count = 0;
+	bool inword = false;
+	for (pos_type pos = from; pos < to; ++pos) {
+		if (par.isWordSeparator(pos))
+			inword = false;
+		else if (!inword) {
+			++count;
+			inword = true;
+		}
+	}
+	return count;
+}
+
+} // namespace
+
+
 int Buffer::spellCheck(DocIterator & from, DocIterator & to,
 	WordLangTuple & word_lang, docstring_list & suggestions) const
 {
@@ -5379,7 +5703,20 @@ int Buffer::spellCheck(DocIterator & from, DocIterator & to,
 		if (from.atEnd() || (!to_end && from >= end))
 			break;
 		to = from;
-		from.paragraph().spellCheck();
+		Paragraph const & par = from.paragraph();
+		par.spellCheck();
+		// The paragraph has been checked as a whole above, so there is
+		// no need to look up its words one by one again: jump straight
+		// to the next misspelling, inset or end of range.
+		pos_type const next = min(par.nextMisspelled(from.pos()),
+		                          textRunEnd(from, end));
+		if (next > from.pos()) {
+			progress += countWordStarts(par, from.pos(), next);
+			from.pos() = next;
+			to = from;
+			if (!to_end && from >= end)
+				break;
+		}
 		SpellChecker::Result res = from.paragraph().spellCheck(from.pos(), to.pos(), wl, suggestions);
 		if (SpellChecker::misspelled(res)) {
 			word_lang = wl;
@@ -5421,6 +5758,31 @@ void Buffer::Impl::updateStatistics(DocIterator & from, DocIterator & to, bool s
 		Paragraph const & par = dit.paragraph();
 		pos_type const pos = dit.pos();
 
+		// Plain characters are counted run by run, there is no need
+		// to step the iterator and to look for insets at each of them.
+		if (pos < dit.lastpos() && !par.isInset(pos)) {
+			pos_type const run_end = textRunEnd(dit, to);
+			if (run_end > pos) {
+				for (pos_type p = pos; p < run_end; ++p) {
+					if (par.isDeleted(p))
+						continue;
+					if (par.isWordSeparator(p))
+						inword = false;
+					else if (!inword) {
+						++word_count_;
+						inword = true;
+					}
+					char_type const c = par.getChar(p);
+					if (isPrintableNonspace(c))
+						++char_count_;
+					else if (isSpace(c))
+						++blank_count_;
+				}
+				dit.top().pos() = run_end;
+				continue;
+			}
+		}
+
 		// Copied and adapted from isWordSeparator() in Paragraph
 		if (pos == dit.lastpos()) {
 			inword = false;
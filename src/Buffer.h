@@ -606,7 +606,10 @@ public:
 	//
 	/// Collect macro definitions in paragraphs
 	void updateMacros() const;
-	/// Iterate through the whole buffer and try to resolve macros
+	/// Iterate through the whole buffer and try to resolve macros.
+	/// Only the instances of macros that have been redefined since the
+	/// last call are resolved again, unless a parent or child document
+	/// is or was involved.
 	void updateMacroInstances(UpdateType) const;
 
 	/// List macro names of this buffer, the parent and the children
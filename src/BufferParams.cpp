@@ -619,18 +619,7 @@ WordLangTable const & BufferParams::spellignore() const
 
 bool BufferParams::spellignored(WordLangTuple const & wl) const
 {
-	bool has_item = false;
-	vector<WordLangTuple> il = spellignore();
-	vector<WordLangTuple>::const_iterator it = il.begin();
-	for (; it != il.end(); ++it) {
-		if (it->lang()->code() != wl.lang()->code())
-			continue;
-		if (it->word() == wl.word()) {
-			has_item = true;
-			break;
-		}
-	}
-	return has_item;
+	return spellignore().contains(wl);
 }
 
 
@@ -1075,7 +1064,7 @@ string BufferParams::readToken(Lexer & lex, string const & token,
 		docstring word = split(wl, language, ' ');
 		Language const * lang = languages.getLanguage(to_ascii(language));
 		if (lang)
-			spellignore().push_back(WordLangTuple(word, lang));
+			spellignore().insert(WordLangTuple(word, lang));
 	} else if (token == "\\author") {
 		lex.eatLine();
 		istringstream ss(lex.getString());
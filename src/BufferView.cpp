@@ -443,9 +443,9 @@ MathRow const & BufferView::mathRow(MathData const * cell) const
 }
 
 
-void BufferView::setMathRow(MathData const * cell, MathRow const & mrow)
+void BufferView::setMathRow(MathData const * cell, MathRow mrow)
 {
-	d->math_rows_[cell] = mrow;
+	d->math_rows_[cell] = move(mrow);
 }
 
 
@@ -3527,6 +3527,29 @@ void BufferView::checkCursorScrollOffset()
 }
 
 
+bool BufferView::needsSpellCheck() const
+{
+	for (auto const & tm_pair : d->text_metrics_)
+		if (tm_pair.second.needsSpellCheck())
+			return true;
+	return false;
+}
+
+
+bool BufferView::spellCheckNext()
+{
+	for (auto & tm_pair : d->text_metrics_) {
+		if (tm_pair.second.spellCheckNext()) {
+			// Only the rows marked as changed need to be repainted
+			if (d->update_strategy_ == NoScreenUpdate)
+				d->update_strategy_ = SingleParUpdate;
+			return true;
+		}
+	}
+	return false;
+}
+
+
 void BufferView::draw(frontend::Painter & pain, bool paint_caret)
 {
 	if (height_ == 0 || width_ == 0)
@@ -323,8 +323,8 @@ public:
 
 	///
 	MathRow const & mathRow(MathData const * cell) const;
-	///
-	void setMathRow(MathData const * cell, MathRow const & mrow);
+	/// Store the row of \p cell. Pass a temporary to avoid a copy.
+	void setMathRow(MathData const * cell, MathRow mrow);
 
 	///
 	Point getPos(DocIterator const & dit) const;
@@ -388,6 +388,14 @@ public:
 	/// Are we currently performing a selection with the mouse?
 	bool mouseSelecting() const;
 
+	/// Have paragraphs been painted without being spellchecked?
+	bool needsSpellCheck() const;
+	/// Spellcheck the next paragraph that has been painted without
+	/// being spellchecked. The rows with updated results are repainted
+	/// on next draw().
+	/// \retval false if there is no such paragraph left.
+	bool spellCheckNext();
+
 private:
 	/// noncopyable
 	BufferView(BufferView const &);
@@ -36,6 +36,7 @@
 #include "frontends/FontMetrics.h"
 #include "frontends/Painter.h"
 
+#include <algorithm>
 #include <ostream>
 
 using namespace std;
@@ -136,6 +137,32 @@ bool Changes::Range::intersects(Range const & r) const
 }
 
 
+namespace {
+
+Change const & unchanged()
+{
+	static Change const no_change = Change(Change::UNCHANGED);
+	return no_change;
+}
+
+} // namespace
+
+
+Changes::ChangeTable::const_iterator Changes::findRange(pos_type const pos) const
+{
+	// The ranges are sorted and do not overlap
+	return upper_bound(table_.begin(), table_.end(), pos,
+		[](pos_type p, ChangeRange const & cr) { return p < cr.range.end; });
+}
+
+
+Changes::ChangeTable::iterator Changes::findRange(pos_type const pos)
+{
+	return upper_bound(table_.begin(), table_.end(), pos,
+		[](pos_type p, ChangeRange const & cr) { return p < cr.range.end; });
+}
+
+
 void Changes::set(Change const & change, pos_type const pos)
 {
 	set(change, pos, pos + 1);
@@ -153,7 +180,8 @@ void Changes::set(Change const & change, pos_type const start, pos_type const en
 
 	Range const newRange(start, end);
 
-	ChangeTable::iterator it = table_.begin();
+	// The ranges before this one end before start
+	ChangeTable::iterator it = findRange(start);
 
 	for (; it != table_.end(); ) {
 		// current change starts like or follows new change
@@ -217,13 +245,13 @@ void Changes::erase(pos_type const pos)
 {
 	LYXERR(Debug::CHANGES, "Erasing change at position " << pos);
 
-	for (ChangeRange & cr : table_) {
+	ChangeTable::iterator it = findRange(pos);
+	for (; it != table_.end(); ++it) {
 		// range (pos,pos+x) becomes (pos,pos+x-1)
-		if (cr.range.start > pos)
-			--(cr.range.start);
+		if (it->range.start > pos)
+			--(it->range.start);
 		// range (pos-x,pos) stays (pos-x,pos)
-		if (cr.range.end > pos)
-			--(cr.range.end);
+		--(it->range.end);
 	}
 
 	merge();
@@ -237,14 +265,14 @@ void Changes::insert(Change const & change, lyx::pos_type pos)
 			<< " at position " << pos);
 	}
 
-	for (ChangeRange & cr : table_) {
+	ChangeTable::iterator it = findRange(pos);
+	for (; it != table_.end(); ++it) {
 		// range (pos,pos+x) becomes (pos+1,pos+x+1)
-		if (cr.range.start >= pos)
-			++(cr.range.start);
+		if (it->range.start >= pos)
+			++(it->range.start);
 
 		// range (pos-x,pos) stays as it is
-		if (cr.range.end > pos)
-			++(cr.range.end);
+		++(it->range.end);
 	}
 
 	set(change, pos, pos + 1); // set will call merge
@@ -253,38 +281,54 @@ void Changes::insert(Change const & change, lyx::pos_type pos)
 
 Change const & Changes::lookup(pos_type const pos) const
 {
-	static Change const noChange = Change(Change::UNCHANGED);
-	for (ChangeRange const & cr : table_)
-		if (cr.range.contains(pos))
-			return cr.change;
-	return noChange;
+	ChangeTable::const_iterator const it = findRange(pos);
+	if (it != table_.end() && it->range.contains(pos))
+		return it->change;
+	return unchanged();
+}
+
+
+Change const & Changes::Cursor::lookup(pos_type const pos)
+{
+	ChangeTable const & table = changes_.table_;
+	// Search from scratch if the table has shrunk or if we went back
+	if (index_ > table.size()
+	    || (index_ > 0 && table[index_ - 1].range.end > pos))
+		index_ = changes_.findRange(pos) - table.begin();
+	while (index_ < table.size() && table[index_].range.end <= pos)
+		++index_;
+	if (index_ < table.size() && table[index_].range.contains(pos))
+		return table[index_].change;
+	return unchanged();
 }
 
 
 bool Changes::isDeleted(pos_type start, pos_type end) const
 {
-	for (ChangeRange const & cr : table_)
-		if (cr.range.contains(Range(start, end))) {
-			LYXERR(Debug::CHANGES, "range ("
-				<< start << ", " << end << ") fully contains ("
-				<< cr.range.start << ", " << cr.range.end
-				<< ") of type " << cr.change.type);
-			return cr.change.type == Change::DELETED;
-		}
+	// Only the range that contains start can contain the whole range
+	ChangeTable::const_iterator const it = findRange(start);
+	if (it != table_.end() && it->range.contains(Range(start, end))) {
+		LYXERR(Debug::CHANGES, "range ("
+			<< start << ", " << end << ") fully contains ("
+			<< it->range.start << ", " << it->range.end
+			<< ") of type " << it->change.type);
+		return it->change.type == Change::DELETED;
+	}
 	return false;
 }
 
 
 bool Changes::isChanged(pos_type const start, pos_type const end) const
 {
-	for (ChangeRange const & cr : table_)
-		if (cr.range.intersects(Range(start, end))) {
-			LYXERR(Debug::CHANGES, "found intersection of range ("
-				<< start << ", " << end << ") with ("
-				<< cr.range.start << ", " << cr.range.end
-				<< ") of type " << cr.change.type);
-			return true;
-		}
+	// The ranges behind this one start even later
+	ChangeTable::const_iterator const it = findRange(start);
+	if (it != table_.end() && it->range.intersects(Range(start, end))) {
+		LYXERR(Debug::CHANGES, "found intersection of range ("
+			<< start << ", " << end << ") with ("
+			<< it->range.start << ", " << it->range.end
+			<< ") of type " << it->change.type);
+		return true;
+	}
 	return false;
 }
 
@@ -300,9 +344,11 @@ bool Changes::isChanged() const
 
 void Changes::merge()
 {
+	// Compact the table in a single pass: out points behind the last
+	// range that is kept.
+	ChangeTable::iterator out = table_.begin();
 	ChangeTable::iterator it = table_.begin();
-
-	while (it != table_.end()) {
+	for (; it != table_.end(); ++it) {
 		LYXERR(Debug::CHANGES, "found change of type " << it->change.type
 			<< " and range (" << it->range.start << ", " << it->range.end
 			<< ")");
@@ -310,33 +356,29 @@ void Changes::merge()
 		if (it->range.start == it->range.end) {
 			LYXERR(Debug::CHANGES, "removing empty range for pos "
 				<< it->range.start);
-
-			table_.erase(it);
-			// start again
-			it = table_.begin();
 			continue;
 		}
 
-		if (it + 1 == table_.end())
-			break;
-
-		if (it->change.isSimilarTo((it + 1)->change)
-		    && it->range.end == (it + 1)->range.start) {
-			LYXERR(Debug::CHANGES, "merging ranges (" << it->range.start << ", "
-				<< it->range.end << ") and (" << (it + 1)->range.start << ", "
-				<< (it + 1)->range.end << ")");
-
-			(it + 1)->range.start = it->range.start;
-			(it + 1)->change.changetime = max(it->change.changetime,
-							  (it + 1)->change.changetime);
-			table_.erase(it);
-			// start again
-			it = table_.begin();
-			continue;
+		if (out != table_.begin()) {
+			ChangeRange & prev = *(out - 1);
+			if (prev.change.isSimilarTo(it->change)
+			    && prev.range.end == it->range.start) {
+				LYXERR(Debug::CHANGES, "merging ranges (" << prev.range.start
+					<< ", " << prev.range.end << ") and (" << it->range.start
+					<< ", " << it->range.end << ")");
+
+				prev.range.end = it->range.end;
+				prev.change.changetime = max(prev.change.changetime,
+							     it->change.changetime);
+				continue;
+			}
 		}
 
-		++it;
+		if (out != it)
+			*out = *it;
+		++out;
 	}
+	table_.erase(out, table_.end());
 }
 
 
@@ -112,6 +112,23 @@ public:
 	/// return the change at the given pos
 	Change const & lookup(pos_type pos) const;
 
+	/// Looks up the changes at increasing positions, e.g. when going
+	/// through a paragraph. Every lookup continues from the range
+	/// found by the previous one instead of searching the table.
+	class Cursor {
+	public:
+		///
+		explicit Cursor(Changes const & changes)
+			: changes_(changes), index_(0) {}
+		/// return the change at the given pos
+		Change const & lookup(pos_type pos);
+	private:
+		///
+		Changes const & changes_;
+		/// The index of the first range that may contain the next pos
+		size_t index_;
+	};
+
 	/// return true if there is a change in the given range (excluding end)
 	bool isChanged(pos_type start, pos_type end) const;
 	///
@@ -177,7 +194,13 @@ private:
 
 	typedef std::vector<ChangeRange> ChangeTable;
 
-	/// table of changes, every row a change and range descriptor
+	/// return the first range that ends after pos
+	ChangeTable::const_iterator findRange(pos_type pos) const;
+	///
+	ChangeTable::iterator findRange(pos_type pos);
+
+	/// table of changes, every row a change and range descriptor.
+	/// The ranges are sorted and do not overlap.
 	ChangeTable table_;
 };
 
@@ -19,13 +19,18 @@
 #include "CutAndPaste.h"
 #include "ErrorList.h"
 #include "Font.h"
+#include "Paragraph.h"
 
 #include "insets/InsetText.h"
 
+#include "support/debug.h"
 #include "support/docstream.h"
 #include "support/lassert.h"
 #include "support/qstring_helpers.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 using namespace std;
 using namespace lyx::support;
 
@@ -234,7 +239,8 @@ public:
 		: abort_(false), n_(0), m_(0), offset_reverse_diagonal_(0),
 		  odd_offset_(false), compare_(compare),
 		  old_buf_(nullptr), new_buf_(nullptr), dest_buf_(nullptr),
-		  dest_pars_(nullptr), recursion_level_(0), nested_inset_level_(0), D_(0)
+		  dest_pars_(nullptr), recursion_level_(0), nested_inset_level_(0),
+		  progress_max_set_(false), progress_(0), D_(0)
 	{}
 
 	///
@@ -289,6 +295,26 @@ private:
 	/// around the middle snake.
 	void diff_i(DocRangePair const & rp);
 
+	/// Matches the paragraphs that occur exactly once in both ranges
+	/// (patience diff) and only runs diff_i on the unmatched parts
+	/// in between. This avoids the character-wise algorithm for the
+	/// large unchanged parts of a document.
+	void diffParagraphs(DocRangePair const & rp);
+
+	/// Finds the pairs of paragraphs in \c rp that are unique in both
+	/// ranges and equal, and which are in the same order in both ranges.
+	/// The old and new paragraph of a pair are returned in \c anchors.
+	void findAnchors(DocRangePair const & rp,
+		vector<pair<pit_type, pit_type>> & anchors);
+
+	/// Writes the common start of the ranges as unchanged and runs
+	/// the algorithm on the remainder.
+	void diffRegion(DocRangePair const & rp);
+
+	/// Diffs the region \p rp between two anchors, and advances the
+	/// progress bar by the length of the region
+	void diffAnchoredRegion(DocRangePair const & rp);
+
 	/// Processes the split chunks. It either adds them as deleted,
 	/// as added, or call diff_i for further processing.
 	void diffPart(DocRangePair const & rp);
@@ -308,6 +334,9 @@ private:
 	/// Writes the paragraph list to the destination buffer
 	void writeToDestBuffer(ParagraphList const & copy_pars) const;
 
+	/// Advances the progress bar by \p steps
+	void progress(size_t steps);
+
 	/// The length of the old chunk currently processed
 	int n_;
 	/// The length of the new chunk currently processed
@@ -337,6 +366,12 @@ private:
 	/// The number of nested insets at this level
 	int nested_inset_level_;
 
+	/// Has the maximum of the progress bar been set ?
+	bool progress_max_set_;
+
+	/// The value of the progress bar
+	size_t progress_;
+
 	/// The position/snake in the old/new document
 	/// of the forward/reverse search
 	compl_vector<DocIterator> ofp;
@@ -538,6 +573,64 @@ static bool traverseSnake(DocPair & p, DocRangePair const & range,
 }
 
 
+/// Returns a hash of the contents of \p par. Paragraphs that are
+/// equal according to equal(DocIterator &, DocIterator &) have the
+/// same hash.
+static size_t paragraphHash(Paragraph const & par)
+{
+	size_t h = par.size();
+	for (pos_type pos = 0; pos < par.size(); ++pos) {
+		h = 31 * h + par.getChar(pos);
+		Inset const * inset = par.getInset(pos);
+		if (!inset)
+			continue;
+		h = 31 * h + inset->lyxCode();
+		// The contents of text insets are compared separately
+		if (inset->editable() && !inset->asInsetMath()
+		      && inset->asInsetText())
+			continue;
+		ostringstream os;
+		inset->write(os);
+		h = 31 * h + hash<string>()(os.str());
+	}
+	return h;
+}
+
+
+/// Returns the position at the start of paragraph \p pit in \p range,
+/// or the end of the range if \p pit is behind its last paragraph.
+static DocIterator paragraphStart(DocRange const & range, pit_type pit)
+{
+	if (pit > range.to.pit())
+		return range.to;
+	DocIterator dit = range.from;
+	dit.pit() = pit;
+	dit.pos() = 0;
+	return dit;
+}
+
+
+/// Returns the position behind paragraph \p pit in \p range. This is
+/// the start of the next paragraph if \p with_break is true and there
+/// is one, and the last position of the paragraph otherwise.
+static DocIterator paragraphEnd(DocRange const & range, pit_type pit,
+	bool with_break)
+{
+	if (with_break && pit < range.to.pit())
+		return paragraphStart(range, pit + 1);
+	DocIterator dit = paragraphStart(range, pit);
+	dit.pos() = dit.lastpos();
+	return dit;
+}
+
+
+/// Returns true if the range consists of complete paragraphs.
+static bool wholeParagraphs(DocRange const & range)
+{
+	return range.from.pos() == 0 && range.to.pos() == range.to.lastpos();
+}
+
+
 /////////////////////////////////////////////////////////////////////
 //
 // Compare::Impl
@@ -720,18 +813,11 @@ bool Compare::Impl::diff(Buffer const * new_buf, Buffer const * old_buf,
 
 	recursion_level_ = 0;
 	nested_inset_level_ = 0;
+	progress_max_set_ = false;
+	progress_ = 0;
 
 	DocRangePair rp(old_buf_, new_buf_);
-
-	DocPair from = rp.from();
-	traverseSnake(from, rp, Forward);
-	DocRangePair const snake(rp.from(), from);
-	processSnake(snake);
-
-	// Start the recursive algorithm
-	DocRangePair rp_new(from, rp.to());
-	if (!rp_new.o.empty() || !rp_new.n.empty())
-		diff_i(rp_new);
+	diffParagraphs(rp);
 
 	for (pit_type p = 0; p < (pit_type)dest_pars_->size(); ++p) {
 		(*dest_pars_)[p].setInsetBuffers(const_cast<Buffer &>(*dest_buf));
@@ -742,6 +828,180 @@ bool Compare::Impl::diff(Buffer const * new_buf, Buffer const * old_buf,
 }
 
 
+void Compare::Impl::findAnchors(DocRangePair const & rp,
+	vector<pair<pit_type, pit_type>> & anchors)
+{
+	anchors.clear();
+	if (!wholeParagraphs(rp.o) || !wholeParagraphs(rp.n))
+		return;
+
+	class Occurrence {
+	public:
+		Occurrence() : old_count(0), new_count(0), old_pit(0), new_pit(0) {}
+		///
+		int old_count;
+		///
+		int new_count;
+		///
+		pit_type old_pit;
+		///
+		pit_type new_pit;
+	};
+	typedef unordered_map<size_t, Occurrence> OccurrenceMap;
+	OccurrenceMap occurrences;
+
+	ParagraphList const & o_pars = rp.o.text()->paragraphs();
+	ParagraphList const & n_pars = rp.n.text()->paragraphs();
+	vector<size_t> o_hashes;
+	o_hashes.reserve(rp.o.to.pit() - rp.o.from.pit() + 1);
+	for (pit_type pit = rp.o.from.pit(); pit <= rp.o.to.pit(); ++pit) {
+		o_hashes.push_back(paragraphHash(o_pars[pit]));
+		Occurrence & occ = occurrences[o_hashes.back()];
+		++occ.old_count;
+		occ.old_pit = pit;
+	}
+	for (pit_type pit = rp.n.from.pit(); pit <= rp.n.to.pit(); ++pit) {
+		Occurrence & occ = occurrences[paragraphHash(n_pars[pit])];
+		++occ.new_count;
+		occ.new_pit = pit;
+	}
+
+	// Collect the paragraphs that are unique in both ranges, in the
+	// order of the old range. The hashes only tell that the paragraphs
+	// may be equal, so check this.
+	vector<pair<pit_type, pit_type>> candidates;
+	for (size_t i = 0; i < o_hashes.size(); ++i) {
+		Occurrence const & occ = occurrences[o_hashes[i]];
+		if (occ.old_count != 1 || occ.new_count != 1)
+			continue;
+		DocRangePair const par_rp(
+			DocRange(paragraphStart(rp.o, occ.old_pit),
+				paragraphEnd(rp.o, occ.old_pit, false)),
+			DocRange(paragraphStart(rp.n, occ.new_pit),
+				paragraphEnd(rp.n, occ.new_pit, false)));
+		DocPair p = par_rp.from();
+		traverseSnake(p, par_rp, Forward);
+		if (p.o == par_rp.o.to && p.n == par_rp.n.to)
+			candidates.push_back(make_pair(occ.old_pit, occ.new_pit));
+		if (abort_)
+			return;
+	}
+
+	// The anchors are the longest subsequence of candidates that is
+	// also increasing in the new range (patience sorting).
+	// tails[l] is the candidate that ends the best subsequence of
+	// length l + 1 found so far.
+	vector<size_t> tails;
+	vector<size_t> previous(candidates.size());
+	vector<pit_type> tail_pits;
+	for (size_t i = 0; i < candidates.size(); ++i) {
+		size_t const l = lower_bound(tail_pits.begin(), tail_pits.end(),
+			candidates[i].second) - tail_pits.begin();
+		previous[i] = l > 0 ? tails[l - 1] : i;
+		if (l == tails.size()) {
+			tails.push_back(i);
+			tail_pits.push_back(candidates[i].second);
+		} else {
+			tails[l] = i;
+			tail_pits[l] = candidates[i].second;
+		}
+	}
+	if (tails.empty())
+		return;
+	anchors.resize(tails.size());
+	size_t i = tails.back();
+	for (size_t l = tails.size(); l > 0; --l) {
+		anchors[l - 1] = candidates[i];
+		i = previous[i];
+	}
+}
+
+
+void Compare::Impl::diffParagraphs(DocRangePair const & rp)
+{
+	vector<pair<pit_type, pit_type>> anchors;
+	findAnchors(rp, anchors);
+	LYXERR(Debug::DEBUG, "Compare: " << anchors.size()
+		<< " unique paragraphs match at inset level " << nested_inset_level_);
+
+	if (anchors.empty()) {
+		diffRegion(rp);
+		return;
+	}
+
+	// Split the ranges at the anchors. Consecutive anchors are written
+	// at once as a single snake.
+	vector<DocRangePair> regions;
+	vector<DocRangePair> snakes;
+	DocPair region_from = rp.from();
+	size_t total = 0;
+	for (size_t i = 0; i < anchors.size(); ) {
+		size_t j = i + 1;
+		while (j < anchors.size()
+		       && anchors[j].first == anchors[j - 1].first + 1
+		       && anchors[j].second == anchors[j - 1].second + 1)
+			++j;
+		DocPair const snake_from(paragraphStart(rp.o, anchors[i].first),
+			paragraphStart(rp.n, anchors[i].second));
+		// The paragraph break belongs to the snake, unless the snake
+		// ends one of the ranges.
+		pit_type const o_last = anchors[j - 1].first;
+		pit_type const n_last = anchors[j - 1].second;
+		bool const with_break =
+			o_last < rp.o.to.pit() && n_last < rp.n.to.pit();
+		DocPair const snake_to(paragraphEnd(rp.o, o_last, with_break),
+			paragraphEnd(rp.n, n_last, with_break));
+		regions.push_back(DocRangePair(region_from, snake_from));
+		snakes.push_back(DocRangePair(snake_from, snake_to));
+		total += regions.back().o.length() + regions.back().n.length();
+		region_from = snake_to;
+		i = j;
+	}
+	DocRangePair const last(region_from, rp.to());
+	total += last.o.length() + last.n.length();
+
+	if (nested_inset_level_ == 0 && !progress_max_set_) {
+		compare_.progressMax(total);
+		progress_max_set_ = true;
+	}
+
+	for (size_t i = 0; i < snakes.size() && !abort_; ++i) {
+		DocRangePair const & region = regions[i];
+		if (!region.o.empty() || !region.n.empty())
+			diffAnchoredRegion(region);
+		processSnake(snakes[i]);
+	}
+	if (!abort_ && (!last.o.empty() || !last.n.empty()))
+		diffAnchoredRegion(last);
+}
+
+
+void Compare::Impl::diffAnchoredRegion(DocRangePair const & rp)
+{
+	size_t const start = progress_;
+	diffRegion(rp);
+	if (nested_inset_level_ > 0 || abort_)
+		return;
+	// The progress bar counts the whole region, but only inserted
+	// and deleted characters have been reported.
+	size_t const length = rp.o.length() + rp.n.length();
+	if (progress_ - start < length)
+		progress(length - (progress_ - start));
+}
+
+
+void Compare::Impl::diffRegion(DocRangePair const & rp)
+{
+	DocPair from = rp.from();
+	traverseSnake(from, rp, Forward);
+	DocRangePair const snake(rp.from(), from);
+	processSnake(snake);
+
+	// Start the recursive algorithm
+	diffPart(DocRangePair(from, rp.to()));
+}
+
+
 void Compare::Impl::diff_i(DocRangePair const & rp)
 {
 	if (abort_)
@@ -755,8 +1015,11 @@ void Compare::Impl::diff_i(DocRangePair const & rp)
 	int const L_ses = findMiddleSnake(rp, middle_snake);
 
 	// Set maximum of progress bar
-	if (++recursion_level_ == 1)
+	if (++recursion_level_ == 1 && nested_inset_level_ == 0
+	    && !progress_max_set_) {
 		compare_.progressMax(L_ses);
+		progress_max_set_ = true;
+	}
 
 	// There are now three possibilities: the strings were the same,
 	// the strings were completely different, or we found a middle
@@ -824,7 +1087,7 @@ void Compare::Impl::diffInset(Inset * inset, DocPair const & p)
 	dest_pars_->clear();
 
 	++nested_inset_level_;
-	diff_i(rp);
+	diffParagraphs(rp);
 	--nested_inset_level_;
 
 	dest_pars_ = backup_dest_pars;
@@ -873,7 +1136,14 @@ void Compare::Impl::writeToDestBuffer(DocRange const & range,
 	writeToDestBuffer(pars);
 
 	if (nested_inset_level_ == 0)
-		compare_.progress(size);
+		progress(size);
+}
+
+
+void Compare::Impl::progress(size_t steps)
+{
+	progress_ += steps;
+	compare_.progress(int(steps));
 }
 
 
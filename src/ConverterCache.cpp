@@ -23,12 +23,15 @@
 #include "support/debug.h"
 #include "support/filetools.h"
 #include "support/lyxtime.h"
+#include "support/mutex.h"
 #include "support/Package.h"
 
 #include "support/checksum.h"
 #include "support/lassert.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <cstdlib>
 #include <fstream>
 #include <iomanip>
 #include <map>
@@ -50,7 +53,7 @@ class CacheItem {
 public:
 	CacheItem() : timestamp(0), checksum(0) {}
 	CacheItem(FileName const & orig_from, string const & to_format,
-		  time_t t, unsigned long c)
+		  time_t t, uint64_t c)
 		: timestamp(t), checksum(c)
 	{
 		ostringstream os;
@@ -66,9 +69,17 @@ public:
 	{}
 	FileName cache_name;
 	time_t timestamp;
-	unsigned long checksum;
+	/// The file checksum, or the content key of an export
+	uint64_t checksum;
 };
 
+
+/// The format name under which exports to \p to_format are stored
+string const exportFormat(string const & to_format)
+{
+	return "export-" + to_format;
+}
+
 } // namespace
 
 
@@ -95,6 +106,8 @@ public:
 	///
 	CacheItem * find(FileName const & from, string const & format);
 	CacheType cache;
+	/// Exports running in worker threads access the cache, too
+	Mutex mutex;
 };
 
 
@@ -118,8 +131,11 @@ void ConverterCache::Impl::readIndex()
 			convert<unsigned long>(lex.getString());
 		if (!lex.next())
 			break;
-		unsigned long const checksum =
-			convert<unsigned long>(lex.getString());
+		// Export keys use 64 bits, which unsigned long may not hold.
+		// Versions that read them as unsigned long truncate them on
+		// some platforms, which only makes the export miss the cache.
+		uint64_t const checksum =
+			strtoull(lex.getString().c_str(), nullptr, 10);
 		FileName const orig_from_name(orig_from);
 		CacheItem item(orig_from_name, to_format, timestamp, checksum);
 
@@ -252,6 +268,7 @@ void ConverterCache::writeIndex() const
 	if (!lyxrc.use_converter_cache
 		  || cache_dir.empty())
 		return;
+	Mutex::Locker lock(&pimpl_->mutex);
 	pimpl_->writeIndex();
 }
 
@@ -262,6 +279,7 @@ void ConverterCache::add(FileName const & orig_from, string const & to_format,
 	if (!lyxrc.use_converter_cache || orig_from.empty() ||
 	    converted_file.empty())
 		return;
+	Mutex::Locker lock(&pimpl_->mutex);
 	LYXERR(Debug::FILES, ' ' << orig_from
 			     << ' ' << to_format << ' ' << converted_file);
 
@@ -329,6 +347,7 @@ void ConverterCache::remove(FileName const & orig_from,
 {
 	if (!lyxrc.use_converter_cache || orig_from.empty())
 		return;
+	Mutex::Locker lock(&pimpl_->mutex);
 	LYXERR(Debug::FILES, orig_from << ' ' << to_format);
 
 	CacheType::iterator const it1 = pimpl_->cache.find(orig_from);
@@ -350,6 +369,7 @@ void ConverterCache::remove_all(string const & from_format,
 {
 	if (!lyxrc.use_converter_cache)
 		return;
+	Mutex::Locker lock(&pimpl_->mutex);
 	CacheType::iterator it1 = pimpl_->cache.begin();
 	while (it1 != pimpl_->cache.end()) {
 		if (it1->second.from_format != from_format) {
@@ -389,6 +409,7 @@ bool ConverterCache::inCache(FileName const & orig_from,
 {
 	if (!lyxrc.use_converter_cache || orig_from.empty())
 		return false;
+	Mutex::Locker lock(&pimpl_->mutex);
 	LYXERR(Debug::FILES, orig_from << ' ' << to_format);
 
 	CacheItem * const item = pimpl_->find(orig_from, to_format);
@@ -428,6 +449,7 @@ bool ConverterCache::inCache(FileName const & orig_from,
 FileName const & ConverterCache::cacheName(FileName const & orig_from,
 		string const & to_format) const
 {
+	Mutex::Locker lock(&pimpl_->mutex);
 	LYXERR(Debug::FILES, orig_from << ' ' << to_format);
 
 	CacheItem * const item = pimpl_->find(orig_from, to_format);
@@ -441,6 +463,7 @@ bool ConverterCache::copy(FileName const & orig_from, string const & to_format,
 {
 	if (!lyxrc.use_converter_cache || orig_from.empty() || dest.empty())
 		return false;
+	Mutex::Locker lock(&pimpl_->mutex);
 	LYXERR(Debug::FILES, orig_from << ' ' << to_format << ' ' << dest);
 
 	// FIXME: Should not hardcode this (see bug 3819 for details)
@@ -461,4 +484,73 @@ bool ConverterCache::copy(FileName const & orig_from, string const & to_format,
 	                  onlyFileName(dest.absFileName()));
 }
 
+
+void ConverterCache::addExport(FileName const & orig_from,
+		string const & to_format, uint64_t key,
+		FileName const & exported_file) const
+{
+	if (!lyxrc.use_converter_cache || orig_from.empty() ||
+	    exported_file.empty())
+		return;
+	Mutex::Locker lock(&pimpl_->mutex);
+	LYXERR(Debug::FILES, orig_from << ' ' << to_format << ' '
+			     << key << ' ' << exported_file);
+
+	string const format = exportFormat(to_format);
+	CacheItem const * const item = pimpl_->find(orig_from, format);
+	if (item && item->checksum == key && item->cache_name.exists()) {
+		LYXERR(Debug::FILES, "Same content key.");
+		return;
+	}
+
+	CacheItem new_item(orig_from, format, current_time(), key);
+	Mover const & mover = getMover(to_format);
+	if (!mover.copy(exported_file, new_item.cache_name,
+	                onlyFileName(new_item.cache_name.absFileName()))) {
+		LYXERR(Debug::FILES, "ConverterCache::addExport(" << orig_from << "):\n"
+					"Could not copy file.");
+		// The old cached file may have been overwritten partially
+		if (item) {
+			new_item.cache_name.removeFile();
+			pimpl_->cache[orig_from].cache.erase(format);
+		}
+		return;
+	}
+	if (!new_item.cache_name.changePermission(0600)) {
+		LYXERR(Debug::FILES, "Could not change file mode"
+			<< new_item.cache_name);
+	}
+	FormatCache & format_cache = pimpl_->cache[orig_from];
+	if (format_cache.from_format.empty())
+		format_cache.from_format =
+			theFormats().getFormatFromFile(orig_from);
+	format_cache.cache[format] = new_item;
+}
+
+
+bool ConverterCache::copyExport(FileName const & orig_from,
+		string const & to_format, uint64_t key,
+		FileName const & dest) const
+{
+	if (!lyxrc.use_converter_cache || orig_from.empty() || dest.empty())
+		return false;
+	Mutex::Locker lock(&pimpl_->mutex);
+	LYXERR(Debug::FILES, orig_from << ' ' << to_format << ' '
+			     << key << ' ' << dest);
+
+	CacheItem const * const item =
+		pimpl_->find(orig_from, exportFormat(to_format));
+	if (!item || !item->cache_name.exists()) {
+		LYXERR(Debug::FILES, "not in cache.");
+		return false;
+	}
+	if (item->checksum != key) {
+		LYXERR(Debug::FILES, "in cache, but content changed.");
+		return false;
+	}
+	Mover const & mover = getMover(to_format);
+	return mover.copy(item->cache_name, dest,
+	                  onlyFileName(dest.absFileName()));
+}
+
 } // namespace lyx
@@ -23,6 +23,8 @@
 
 #include "support/strfwd.h"
 
+#include <cstdint>
+
 
 namespace lyx {
 
@@ -44,7 +46,14 @@ namespace support { class FileName; }
  *   identical with the actual checksum of \c orig_from.
  * Otherwise the item is not considered up to date, and add() will refresh it.
  *
- * There is no cache maintenance yet (max size, max age etc.)
+ * The cache also holds exported documents (see addExport()). For these
+ * items \c orig_from is the document file and the checksum is not the one
+ * of \c orig_from, but a content key computed by the caller over
+ * everything the export depends on. They are stored in the same index
+ * with a format name prefixed by "export-".
+ *
+ * Cached files older than lyxrc.converter_cache_maxage are removed from
+ * the cache when the index is read.
  */
 class ConverterCache {
 public:
@@ -88,6 +97,24 @@ public:
 	bool copy(support::FileName const & orig_from, std::string const & to_format,
 		  support::FileName const & dest) const;
 
+	/**
+	 * Add \c exported_file, the result of exporting the document
+	 * \c orig_from to \c to_format, to the cache. \c key is the content
+	 * key of the export (see Buffer::doExport()).
+	 */
+	void addExport(support::FileName const & orig_from,
+		       std::string const & to_format, uint64_t key,
+		       support::FileName const & exported_file) const;
+
+	/**
+	 * Copy the result of exporting \c orig_from to \c to_format to
+	 * \p dest if it is in the cache and was produced with content key
+	 * \c key. Returns \c false otherwise.
+	 */
+	bool copyExport(support::FileName const & orig_from,
+			std::string const & to_format, uint64_t key,
+			support::FileName const & dest) const;
+
 private:
 	/// noncopyable
 	ConverterCache(ConverterCache const &);
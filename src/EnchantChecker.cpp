@@ -119,7 +119,7 @@ EnchantChecker::~EnchantChecker()
 
 
 SpellChecker::Result EnchantChecker::check(WordLangTuple const & word,
-        std::vector<WordLangTuple> const & docdict)
+        WordLangTable const & docdict)
 {
 	enchant::Dict * m = d->speller(word.lang()->code());
 
@@ -129,18 +129,16 @@ SpellChecker::Result EnchantChecker::check(WordLangTuple const & word,
 	if (word.word().empty())
 		return WORD_OK;
 
-	string utf8word = to_utf8(word.word());
-
-	if (m->check(utf8word))
+	Result result;
+	if (!cachedResult(word, result)) {
+		result = m->check(to_utf8(word.word())) ? WORD_OK : UNKNOWN_WORD;
+		cacheResult(word, result);
+	}
+	if (result == WORD_OK)
 		return WORD_OK;
 
-	vector<WordLangTuple>::const_iterator it = docdict.begin();
-	for (; it != docdict.end(); ++it) {
-		if (it->lang()->code() != word.lang()->code())
-			continue;
-		if (it->word() == word.word())
-			return DOCUMENT_LEARNED_WORD;
-	}
+	if (docdict.contains(word))
+		return DOCUMENT_LEARNED_WORD;
 
 	return UNKNOWN_WORD;
 }
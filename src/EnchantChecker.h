@@ -33,7 +33,7 @@ public:
 	/// SpellChecker inherited methods.
 	///@{
 	enum Result check(WordLangTuple const &,
-			  std::vector<WordLangTuple> const &) override;
+			  WordLangTable const &) override;
 	void suggest(WordLangTuple const &, docstring_list &) override;
 	void stem(WordLangTuple const &, docstring_list &) override {}
 	void insert(WordLangTuple const &) override;
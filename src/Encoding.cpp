@@ -16,16 +16,21 @@
 
 #include "Lexer.h"
 
+#include "support/binaryio.h"
 #include "support/debug.h"
 #include "support/docstring.h"
+#include "support/FileName.h"
+#include "support/filetools.h"
 #include "support/gettext.h"
 #include "support/lstrings.h"
 #include "support/mutex.h"
+#include "support/Package.h"
 #include "support/textutils.h"
 #include "support/unicode.h"
 
 #include <algorithm>
 #include <cstdint>
+#include <fstream>
 #include <iterator>
 #include <sstream>
 
@@ -59,9 +64,118 @@ MathAlphaSet mathalpha;
 /// The highest code point in UCS4 encoding (1<<20 + 1<<16)
 char_type const max_ucs4 = 0x110000;
 
+
+/**
+ * Two-level lookup table from code points to the entries of
+ * unicodesymbols. The table is built once after the symbols are read,
+ * so that the lookup during export costs two array accesses instead of
+ * a tree search.
+ */
+class CharInfoTable {
+public:
+	///
+	CharInfo const * find(char_type c) const
+	{
+		size_t const page = c >> page_bits;
+		if (page >= pages_.size() || pages_[page].empty())
+			return nullptr;
+		return pages_[page][c & page_mask];
+	}
+	///
+	void build(CharInfoMap const & symbols)
+	{
+		pages_.clear();
+		for (auto const & p : symbols) {
+			size_t const page = p.first >> page_bits;
+			if (page >= pages_.size())
+				pages_.resize(page + 1);
+			if (pages_[page].empty())
+				pages_[page].resize(page_size, nullptr);
+			pages_[page][p.first & page_mask] = &p.second;
+		}
+	}
+private:
+	///
+	enum {
+		page_bits = 8,
+		page_size = 1 << page_bits,
+		page_mask = page_size - 1
+	};
+	///
+	vector<vector<CharInfo const *>> pages_;
+};
+
+/// Fast lookup of the entries in unicodesymbols
+CharInfoTable charinfotable;
+
+/// The contents of mathalpha
+CharBitmap mathalphabitmap;
+
+/// The characters we can't encode, keyed by encoding name. This is
+/// forced united with the respective entry of forcedSelected.
+map<string, CharBitmap> forcedbitmaps;
+
+
+/// Fill the lookup tables from unicodesymbols and mathalpha
+void buildSymbolTables()
+{
+	charinfotable.build(unicodesymbols);
+	mathalphabitmap.clear();
+	for (char_type c : mathalpha)
+		mathalphabitmap.insert(c);
+}
+
+
+/// Fill forcedbitmaps from forced and forcedSelected
+void buildForcedTables()
+{
+	for (auto const & p : forcedSelected) {
+		CharBitmap & chars = forcedbitmaps[p.first];
+		chars.clear();
+		for (char_type c : forced)
+			chars.insert(c);
+		for (char_type c : p.second)
+			chars.insert(c);
+	}
+}
+
 } // namespace
 
 
+void CharBitmap::insert(char_type c)
+{
+	size_t const page = c >> page_bits;
+	if (page >= pages_.size())
+		pages_.resize(page + 1);
+	if (pages_[page].empty())
+		pages_[page].resize(page_size / 64, 0);
+	size_t const bit = c & page_mask;
+	pages_[page][bit / 64] |= uint64_t(1) << (bit % 64);
+}
+
+
+void CharBitmap::erase(char_type c)
+{
+	size_t const page = c >> page_bits;
+	if (page >= pages_.size() || pages_[page].empty())
+		return;
+	size_t const bit = c & page_mask;
+	pages_[page][bit / 64] &= ~(uint64_t(1) << (bit % 64));
+}
+
+
+void CharBitmap::list(vector<char_type> & chars) const
+{
+	for (size_t page = 0; page < pages_.size(); ++page) {
+		if (pages_[page].empty())
+			continue;
+		for (size_t bit = 0; bit < page_size; ++bit)
+			if ((pages_[page][bit / 64] >> (bit % 64)) & 1)
+				chars.push_back(char_type((page << page_bits) | bit));
+	}
+}
+
+
 EncodingException::EncodingException(char_type c)
 	: failed_char(c), par_id(0), pos(0)
 {
@@ -99,8 +213,10 @@ CharInfo::CharInfo(
 Encoding::Encoding(string const & n, string const & l, string const & g,
 		   string const & i, bool f, bool u, Encoding::Package p)
 	: name_(n), latexName_(l), guiName_(g), iconvName_(i), fixedwidth_(f),
-	  unsafe_(u), forced_(&forcedSelected[n]), package_(p)
+	  unsafe_(u), forced_(&forcedbitmaps[n]), package_(p)
 {
+	// Make sure that buildForcedTables() fills forced_
+	forcedSelected[n];
 	if (n == "ascii") {
 		// ASCII can encode 128 code points and nothing else
 		start_encodable_ = 128;
@@ -136,7 +252,7 @@ void Encoding::init() const
 	// that all const methods are thread-safe: init() is the only const
 	// method which changes complete_, encodable_ and start_encodable_, and
 	// it uses a mutex to ensure thread-safety.
-	CharSet & encodable = const_cast<Encoding *>(this)->encodable_;
+	CharBitmap & encodable = const_cast<Encoding *>(this)->encodable_;
 	char_type & start_encodable = const_cast<Encoding *>(this)->start_encodable_;
 
 	start_encodable = 0;
@@ -151,13 +267,9 @@ void Encoding::init() const
 			if (ucs4.size() != 1)
 				continue;
 			char_type const uc = ucs4[0];
-			CharInfoMap::const_iterator const it = unicodesymbols.find(uc);
-			if (it == unicodesymbols.end())
+			// forced_ contains all characters with the force flag
+			if (!charinfotable.find(uc) || !forced_->contains(uc))
 				encodable.insert(uc);
-			else if (!it->second.force()) {
-				if (forced_->empty() || forced_->find(uc) == forced_->end())
-					encodable.insert(uc);
-			}
 		}
 	} else {
 		// We do not know how many code points this encoding has, and
@@ -166,23 +278,15 @@ void Encoding::init() const
 		// This is expensive!
 		for (char_type c = 0; c < max_ucs4; ++c) {
 			vector<char> const eightbit = ucs4_to_eightbit(&c, 1, iconvName_);
-			if (!eightbit.empty()) {
-				CharInfoMap::const_iterator const it = unicodesymbols.find(c);
-				if (it == unicodesymbols.end())
-					encodable.insert(c);
-				else if (!it->second.force()) {
-					if (forced_->empty() || forced_->find(c) == forced_->end())
-						encodable.insert(c);
-				}
-			}
+			if (!eightbit.empty()
+			    && (!charinfotable.find(c) || !forced_->contains(c)))
+				encodable.insert(c);
 		}
 	}
 	lyxerr.enable();
-	CharSet::iterator it = encodable.find(start_encodable);
-	while (it != encodable.end()) {
-		encodable.erase(it);
+	while (encodable.contains(start_encodable)) {
+		encodable.erase(start_encodable);
 		++start_encodable;
-		it = encodable.find(start_encodable);
 	}
 	const_cast<Encoding *>(this)->complete_ = true;
 }
@@ -190,9 +294,7 @@ void Encoding::init() const
 
 bool Encoding::isForced(char_type c) const
 {
-	if (!forced.empty() && forced.find(c) != forced.end())
-		return true;
-	return !forced_->empty() && forced_->find(c) != forced_->end();
+	return forced_->contains(c);
 }
 
 
@@ -212,9 +314,7 @@ bool Encoding::encodable(char_type c) const
 		return false;
 	if (c < start_encodable_ && !isForced(c))
 		return true;
-	if (encodable_.find(c) != encodable_.end())
-		return true;
-	return false;
+	return encodable_.contains(c);
 }
 
 
@@ -224,14 +324,14 @@ pair<docstring, bool> Encoding::latexChar(char_type c) const
 		return make_pair(docstring(1, c), false);
 
 	// c cannot (or should not) be encoded in this encoding
-	CharInfoMap::const_iterator const it = unicodesymbols.find(c);
-	if (it == unicodesymbols.end())
+	CharInfo const * info = charinfotable.find(c);
+	if (!info)
 		throw EncodingException(c);
 	// at least one of mathCommand and textCommand is nonempty
-	if (it->second.textCommand().empty())
+	if (info->textCommand().empty())
 		return make_pair(
-				"\\ensuremath{" + it->second.mathCommand() + '}', false);
-	return make_pair(it->second.textCommand(), !it->second.textNoTermination());
+				"\\ensuremath{" + info->mathCommand() + '}', false);
+	return make_pair(info->textCommand(), !info->textNoTermination());
 }
 
 
@@ -283,14 +383,13 @@ vector<char_type> Encoding::symbolsList() const
 	for (char_type c = 0; c < start_encodable_; ++c)
 		symbols.push_back(c);
 	// add all encodable characters
-	copy(encodable_.begin(), encodable_.end(), back_inserter(symbols));
-	// now the ones from the unicodesymbols file that are not already there
-	for (auto const & elem : unicodesymbols) {
-		if (find(symbols.begin(), symbols.end(), elem.first) == symbols.end())
-			symbols.push_back(elem.first);
-	}
-	// finally, sort the vector
+	encodable_.list(symbols);
+	// now the ones from the unicodesymbols file
+	for (auto const & elem : unicodesymbols)
+		symbols.push_back(elem.first);
+	// finally, sort the vector and remove the duplicates
 	sort(symbols.begin(), symbols.end());
+	symbols.erase(unique(symbols.begin(), symbols.end()), symbols.end());
 	return symbols;
 }
 
@@ -305,8 +404,8 @@ bool Encodings::latexMathChar(char_type c, bool mathmode,
 			command = docstring(1, c);
 	needsTermination = false;
 
-	CharInfoMap::const_iterator const it = unicodesymbols.find(c);
-	if (it == unicodesymbols.end()) {
+	CharInfo const * info = charinfotable.find(c);
+	if (!info) {
 		if (!encoding || command.empty())
 			throw EncodingException(c);
 		if (mathmode)
@@ -314,16 +413,16 @@ bool Encodings::latexMathChar(char_type c, bool mathmode,
 		return false;
 	}
 	// at least one of mathCommand and textCommand is nonempty
-	bool use_math = (mathmode && !it->second.mathCommand().empty()) ||
-	                (!mathmode && it->second.textCommand().empty());
+	bool use_math = (mathmode && !info->mathCommand().empty()) ||
+	                (!mathmode && info->textCommand().empty());
 	if (use_math) {
-		command = it->second.mathCommand();
-		needsTermination = !it->second.mathNoTermination();
+		command = info->mathCommand();
+		needsTermination = !info->mathNoTermination();
 		addMathCmd(c);
 	} else {
 		if (!encoding || command.empty()) {
-			command = it->second.textCommand();
-			needsTermination = !it->second.textNoTermination();
+			command = info->textCommand();
+			needsTermination = !info->textNoTermination();
 		}
 		if (mathmode)
 			addMathSym(c);
@@ -617,40 +716,38 @@ docstring Encodings::fromLaTeXCommand(docstring const & cmd, int cmdtype,
 CharInfo const & Encodings::unicodeCharInfo(char_type c)
 {
 	static CharInfo empty;
-	CharInfoMap::const_iterator const it = unicodesymbols.find(c);
-	return it != unicodesymbols.end() ? it->second : empty;
+	CharInfo const * info = charinfotable.find(c);
+	return info ? *info : empty;
 }
 
 
 bool Encodings::isCombiningChar(char_type c)
 {
-	CharInfoMap::const_iterator const it = unicodesymbols.find(c);
-	if (it != unicodesymbols.end())
-		return it->second.combining();
-	return false;
+	CharInfo const * info = charinfotable.find(c);
+	return info && info->combining();
 }
 
 
 string const Encodings::TIPAShortcut(char_type c)
 {
-	CharInfoMap::const_iterator const it = unicodesymbols.find(c);
-	if (it != unicodesymbols.end())
-		return it->second.tipaShortcut();
+	CharInfo const * info = charinfotable.find(c);
+	if (info)
+		return info->tipaShortcut();
 	return string();
 }
 
 
 string const Encodings::isKnownScriptChar(char_type const c)
 {
-	CharInfoMap::const_iterator const it = unicodesymbols.find(c);
+	CharInfo const * info = charinfotable.find(c);
 
-	if (it == unicodesymbols.end())
+	if (!info)
 		return string();
 	// FIXME: parse complex textPreamble (may be list or alternatives,
 	// 		  e.g., "subscript,textgreek" or "textcomp|textgreek")
-	if (it->second.textPreamble() == "textgreek"
-		|| it->second.textPreamble() == "textcyrillic")
-		return it->second.textPreamble();
+	if (info->textPreamble() == "textgreek"
+		|| info->textPreamble() == "textcyrillic")
+		return info->textPreamble();
 	return string();
 }
 
@@ -668,7 +765,7 @@ bool Encodings::fontencSupportsScript(string const & fontenc, string const & scr
 
 bool Encodings::isMathAlpha(char_type c)
 {
-	return mathalpha.count(c);
+	return mathalphabitmap.contains(c);
 }
 
 
@@ -677,8 +774,8 @@ bool Encodings::isUnicodeTextOnly(char_type c)
 	if (isASCII(c) || isMathAlpha(c))
 		return false;
 
-	CharInfoMap::const_iterator const it = unicodesymbols.find(c);
-	return it == unicodesymbols.end() || it->second.mathCommand().empty();
+	CharInfo const * info = charinfotable.find(c);
+	return !info || info->mathCommand().empty();
 }
 
 
@@ -733,11 +830,11 @@ Encodings::Encodings()
 {}
 
 
-void Encodings::read(FileName const & encfile, FileName const & symbolsfile)
+namespace {
+
+/// Read the unicodesymbols file \p symbolsfile
+void readSymbols(FileName const & symbolsfile, CharSetMap & forcedNotSelected)
 {
-	// We must read the symbolsfile first, because the Encoding
-	// constructor depends on it.
-	CharSetMap forcedNotSelected;
 	Lexer symbolsLex;
 	symbolsLex.setFile(symbolsfile);
 	bool getNextToken = true;
@@ -894,6 +991,180 @@ void Encodings::read(FileName const & encfile, FileName const & symbolsfile)
 		if (breakout)
 			break;
 	}
+}
+
+
+/// Identifies the format of the cache file, change on format changes
+string const symbols_cache_magic = "LyXUnicodeSymbols 1";
+
+
+FileName symbolsCacheFile()
+{
+	return FileName(addName(package().user_support().absFileName(),
+	                        "unicodesymbols.cache"));
+}
+
+
+void writeSet(ostream & os, CharSet const & chars)
+{
+	writeNumber(os, chars.size());
+	for (char_type const c : chars)
+		writeNumber(os, c);
+}
+
+
+bool readSet(istream & is, CharSet & chars)
+{
+	uint64_t size;
+	if (!readNumber(is, size))
+		return false;
+	for (uint64_t i = 0; i < size; ++i) {
+		uint64_t c;
+		if (!readNumber(is, c))
+			return false;
+		chars.insert(chars.end(), char_type(c));
+	}
+	return true;
+}
+
+
+void writeSetMap(ostream & os, CharSetMap const & sets)
+{
+	writeNumber(os, sets.size());
+	for (auto const & p : sets) {
+		writeString(os, p.first);
+		writeSet(os, p.second);
+	}
+}
+
+
+bool readSetMap(istream & is, CharSetMap & sets)
+{
+	uint64_t size;
+	if (!readNumber(is, size))
+		return false;
+	for (uint64_t i = 0; i < size; ++i) {
+		string name;
+		if (!readString(is, name) || !readSet(is, sets[name]))
+			return false;
+	}
+	return true;
+}
+
+
+/// Read the contents of \p symbolsfile from the cache, if that is up
+/// to date. This is much faster than parsing the file.
+bool readSymbolsCache(FileName const & symbolsfile,
+                      CharSetMap & forcedNotSelected)
+{
+	FileName const cachefile = symbolsCacheFile();
+	if (!cachefile.isReadableFile())
+		return false;
+	ifstream is(cachefile.toFilesystemEncoding().c_str(), ios::binary);
+	string magic;
+	string source;
+	uint64_t timestamp;
+	uint64_t checksum;
+	if (!readString(is, magic) || magic != symbols_cache_magic
+	    || !readString(is, source) || source != symbolsfile.absFileName()
+	    || !readNumber(is, timestamp) || !readNumber(is, checksum))
+		return false;
+	if (time_t(timestamp) != symbolsfile.lastModified()
+	    && checksum != symbolsfile.checksum())
+		return false;
+
+	CharInfoMap symbols;
+	uint64_t size;
+	if (!readNumber(is, size))
+		return false;
+	for (uint64_t i = 0; i < size; ++i) {
+		uint64_t c;
+		vector<docstring> text_commands;
+		vector<docstring> math_commands;
+		string text_preamble;
+		string math_preamble;
+		string tipa_shortcut;
+		uint64_t flags;
+		if (!readNumber(is, c) || !readStrings(is, text_commands)
+		    || !readStrings(is, math_commands)
+		    || !readString(is, text_preamble)
+		    || !readString(is, math_preamble)
+		    || !readString(is, tipa_shortcut) || !readNumber(is, flags))
+			return false;
+		symbols.insert(symbols.end(), make_pair(char_type(c),
+			CharInfo(text_commands, math_commands, text_preamble,
+			         math_preamble, tipa_shortcut, unsigned(flags))));
+	}
+	CharSet forced_symbols;
+	CharSet mathalpha_symbols;
+	CharSetMap forced_selected;
+	CharSetMap forced_not_selected;
+	if (!readSet(is, forced_symbols) || !readSet(is, mathalpha_symbols)
+	    || !readSetMap(is, forced_selected)
+	    || !readSetMap(is, forced_not_selected))
+		return false;
+
+	// Everything is there, use it
+	for (auto & p : symbols)
+		unicodesymbols[p.first] = move(p.second);
+	forced.insert(forced_symbols.begin(), forced_symbols.end());
+	mathalpha.insert(mathalpha_symbols.begin(), mathalpha_symbols.end());
+	for (auto const & p : forced_selected)
+		forcedSelected[p.first].insert(p.second.begin(), p.second.end());
+	for (auto const & p : forced_not_selected)
+		forcedNotSelected[p.first].insert(p.second.begin(), p.second.end());
+	LYXERR(Debug::INIT, "Read " << symbols.size() << " unicode symbols from "
+	       << cachefile);
+	return true;
+}
+
+
+/// Store the contents of \p symbolsfile that have just been read
+void writeSymbolsCache(FileName const & symbolsfile,
+                       CharSetMap const & forcedNotSelected)
+{
+	FileName const cachefile = symbolsCacheFile();
+	if (!cachefile.onlyPath().isDirWritable())
+		return;
+	// Other LyX or tex2lyx processes may read the file concurrently,
+	// so it is not written in place
+	ostringstream os;
+	writeString(os, symbols_cache_magic);
+	writeString(os, symbolsfile.absFileName());
+	writeNumber(os, symbolsfile.lastModified());
+	writeNumber(os, symbolsfile.checksum());
+	writeNumber(os, unicodesymbols.size());
+	for (auto const & p : unicodesymbols) {
+		CharInfo const & info = p.second;
+		writeNumber(os, p.first);
+		writeStrings(os, info.textCommands());
+		writeStrings(os, info.mathCommands());
+		writeString(os, info.textPreamble());
+		writeString(os, info.mathPreamble());
+		writeString(os, info.tipaShortcut());
+		writeNumber(os, info.flags());
+	}
+	writeSet(os, forced);
+	writeSet(os, mathalpha);
+	writeSetMap(os, forcedSelected);
+	writeSetMap(os, forcedNotSelected);
+	if (!replaceFile(cachefile, os.str()))
+		LYXERR(Debug::INIT, "Could not write " << cachefile);
+}
+
+} // namespace
+
+
+void Encodings::read(FileName const & encfile, FileName const & symbolsfile)
+{
+	// We must read the symbolsfile first, because the Encoding
+	// constructor depends on it.
+	CharSetMap forcedNotSelected;
+	if (!readSymbolsCache(symbolsfile, forcedNotSelected)) {
+		readSymbols(symbolsfile, forcedNotSelected);
+		writeSymbolsCache(symbolsfile, forcedNotSelected);
+	}
+	buildSymbolTables();
 
 	// Now read the encodings
 	enum {
@@ -977,6 +1248,7 @@ void Encodings::read(FileName const & encfile, FileName const & symbolsfile)
 				it2->second.insert(it1->second.begin(), it1->second.end());
 		}
 	}
+	buildForcedTables();
 
 }
 
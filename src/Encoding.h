@@ -17,6 +17,7 @@
 #include "support/trivstring.h"
 #include "support/types.h"
 
+#include <cstdint>
 #include <map>
 #include <set>
 #include <vector>
@@ -109,6 +110,8 @@ public:
 	bool textNoTermination() const { return flags_ & CharInfoTextNoTermination; }
 	/// \c mathCommand needs no termination (such as {} or space).
 	bool mathNoTermination() const { return flags_ & CharInfoMathNoTermination; }
+	/// All the flags, for storage
+	unsigned int flags() const { return flags_; }
 	///
 private:
 	/// LaTeX commands (text mode) for this character. The first one is the default, the others
@@ -128,6 +131,43 @@ private:
 };
 
 
+/**
+ * A set of UCS4 characters, stored as a two-level bitmap.
+ * The code points are split into pages of 256 characters, and only the
+ * pages that contain at least one member are allocated, so that a lookup
+ * costs two array accesses.
+ */
+class CharBitmap {
+public:
+	/// Is \p c a member of the set?
+	bool contains(char_type c) const
+	{
+		size_t const page = c >> page_bits;
+		if (page >= pages_.size() || pages_[page].empty())
+			return false;
+		size_t const bit = c & page_mask;
+		return (pages_[page][bit / 64] >> (bit % 64)) & 1;
+	}
+	///
+	void insert(char_type c);
+	///
+	void erase(char_type c);
+	///
+	void clear() { pages_.clear(); }
+	/// Append all members in ascending order to \p chars
+	void list(std::vector<char_type> & chars) const;
+private:
+	///
+	enum {
+		page_bits = 8,
+		page_size = 1 << page_bits,
+		page_mask = page_size - 1
+	};
+	/// Each non-empty page holds the bits of page_size code points
+	std::vector<std::vector<std::uint64_t>> pages_;
+};
+
+
 /**
  * An encoding as defined in lib/encodings.
  * All const methods are thread-safe, so the caller does not need any locking.
@@ -215,13 +255,12 @@ private:
 	/// Is this encoding TeX unsafe, e.g. control characters like {, }
 	/// and \\ may appear in high bytes?
 	bool unsafe_;
-	///
-	typedef std::set<char_type> CharSet;
 	/// Set of UCS4 characters that we can encode (for singlebyte
 	/// encodings only)
-	CharSet encodable_;
-	/// Set of UCS4 characters that we can't encode
-	CharSet const * forced_;
+	CharBitmap encodable_;
+	/// Set of UCS4 characters that we can't encode. This includes the
+	/// characters that are forced for all encodings.
+	CharBitmap const * forced_;
 	/// All code points below this are encodable. This helps us to avoid
 	/// lokup of ASCII characters in encodable_ and gives about 1 sec
 	/// speedup on export of the Userguide.
@@ -20,31 +20,45 @@
 
 #include "FontList.h"
 
+#include <algorithm>
+
 using namespace std;
 
 namespace lyx {
 
 
+namespace {
+
+bool endsBefore(FontTable const & ft, pos_type pos)
+{
+	return ft.pos() < pos;
+}
+
+} // namespace
+
+
 FontList::iterator FontList::fontIterator(pos_type pos)
 {
-	FontList::iterator it = list_.begin();
-	FontList::iterator end = list_.end();
-	for (; it != end; ++it) {
-		if (it->pos() >= pos)
-			break;
-	}
-	return it;
+	// The entries are sorted by their end position
+	return lower_bound(list_.begin(), list_.end(), pos, endsBefore);
 }
 
 
 FontList::const_iterator FontList::fontIterator(pos_type pos) const
 {
-	FontList::const_iterator it = list_.begin();
-	FontList::const_iterator end = list_.end();
-	for (; it != end; ++it) {
-		if (it->pos() >= pos)
-			break;
-	}
+	return lower_bound(list_.begin(), list_.end(), pos, endsBefore);
+}
+
+
+FontList::const_iterator FontList::fontIterator(const_iterator it,
+	pos_type pos) const
+{
+	// Search from scratch if we went back
+	if (it != list_.begin() && prev(it, 1)->pos() >= pos)
+		return fontIterator(pos);
+	const_iterator const end = list_.end();
+	while (it != end && it->pos() < pos)
+		++it;
 	return it;
 }
 
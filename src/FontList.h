@@ -91,6 +91,10 @@ public:
 	iterator fontIterator(pos_type pos);
 	///
 	const_iterator fontIterator(pos_type pos) const;
+	/// Same as fontIterator(pos), but searches forward from \p it,
+	/// which is the result for a previous position. This makes going
+	/// through the positions of a paragraph in order linear in total.
+	const_iterator fontIterator(const_iterator it, pos_type pos) const;
 	///
 	Font const & get(pos_type pos);
 	///
@@ -67,6 +67,8 @@ struct HunspellChecker::Private
 	Hunspell * addSpeller(Language const * lang);
 	Hunspell * speller(Language const * lang);
 	Hunspell * lookup(Language const * lang);
+	/// check \p wl with the speller and the personal word list
+	SpellChecker::Result check(WordLangTuple const & wl);
 	/// ignored words
 	bool isIgnored(WordLangTuple const & wl) const;
 	/// personal word list interface
@@ -281,14 +283,7 @@ int HunspellChecker::Private::numDictionaries() const
 
 bool HunspellChecker::Private::isIgnored(WordLangTuple const & wl) const
 {
-	WordLangTable::const_iterator it = ignored_.begin();
-	for (; it != ignored_.end(); ++it) {
-		if (it->lang()->code() != wl.lang()->code())
-			continue;
-		if (it->word() == wl.word())
-			return true;
-	}
-	return false;
+	return ignored_.contains(wl);
 }
 
 /// personal word list interface
@@ -342,21 +337,9 @@ HunspellChecker::~HunspellChecker()
 }
 
 
-SpellChecker::Result HunspellChecker::check(WordLangTuple const & wl,
-					    vector<WordLangTuple> const & docdict)
+SpellChecker::Result HunspellChecker::Private::check(WordLangTuple const & wl)
 {
-	if (d->isIgnored(wl))
-		return WORD_OK;
-
-	WordLangTable::const_iterator it = docdict.begin();
-	for (; it != docdict.end(); ++it) {
-		if (it->lang()->code() != wl.lang()->code())
-			continue;
-		if (it->word() == wl.word())
-			return DOCUMENT_LEARNED_WORD;
-	}
-
-	Hunspell * h = d->speller(wl.lang());
+	Hunspell * h = speller(wl.lang());
 	if (!h)
 		return NO_DICTIONARY;
 	int info;
@@ -371,7 +354,7 @@ SpellChecker::Result HunspellChecker::check(WordLangTuple const & wl,
 #else
 	if (h->spell(word_to_check.c_str(), &info))
 #endif
-		return d->learned(wl) ? LEARNED_WORD : WORD_OK;
+		return learned(wl) ? LEARNED_WORD : WORD_OK;
 
 	if (info & SPELL_COMPOUND) {
 		// FIXME: What to do with that?
@@ -386,6 +369,24 @@ SpellChecker::Result HunspellChecker::check(WordLangTuple const & wl,
 }
 
 
+SpellChecker::Result HunspellChecker::check(WordLangTuple const & wl,
+					    WordLangTable const & docdict)
+{
+	if (d->isIgnored(wl))
+		return WORD_OK;
+
+	if (docdict.contains(wl))
+		return DOCUMENT_LEARNED_WORD;
+
+	Result result;
+	if (cachedResult(wl, result))
+		return result;
+	result = d->check(wl);
+	cacheResult(wl, result);
+	return result;
+}
+
+
 void HunspellChecker::advanceChangeNumber()
 {
 	nextChangeNumber();
@@ -410,7 +411,7 @@ void HunspellChecker::remove(WordLangTuple const & wl)
 
 void HunspellChecker::accept(WordLangTuple const & wl)
 {
-	d->ignored_.push_back(wl);
+	d->ignored_.insert(wl);
 	LYXERR(Debug::GUI, "ignore word: \"" << wl.word() << "\"") ;
 	advanceChangeNumber();
 }
@@ -60,7 +60,7 @@ namespace {
 
 // The format should also be updated in configure.py, and conversion code
 // should be added to prefs2prefs_prefs.py.
-static unsigned int const LYXRC_FILEFORMAT = 37; // chillenb: screen_width and screen_limit
+static unsigned int const LYXRC_FILEFORMAT = 38; // undo_memory_limit
 // when adding something to this array keep it sorted!
 LexerKeyword lyxrcTags[] = {
 	{ "\\accept_compound", LyXRC::RC_ACCEPT_COMPOUND },
@@ -197,6 +197,7 @@ LexerKeyword lyxrcTags[] = {
 	{ "\\texinputs_prefix", LyXRC::RC_TEXINPUTS_PREFIX },
 	{ "\\thesaurusdir_path", LyXRC::RC_THESAURUSDIRPATH },
 	{ "\\ui_file", LyXRC::RC_UIFILE },
+	{ "\\undo_memory_limit", LyXRC::RC_UNDO_MEMORY_LIMIT },
 	{ "\\use_converter_cache", LyXRC::RC_USE_CONVERTER_CACHE },
 	{ "\\use_converter_needauth", LyXRC::RC_USE_CONVERTER_NEEDAUTH },
 	{ "\\use_converter_needauth_forbidden", LyXRC::RC_USE_CONVERTER_NEEDAUTH_FORBIDDEN },
@@ -539,6 +540,10 @@ LyXRC::ReturnValues LyXRC::read(Lexer & lexrc, bool check_format)
 			lexrc >> use_lastfilepos;
 			break;
 
+		case RC_UNDO_MEMORY_LIMIT:
+			lexrc >> undo_memory_limit;
+			break;
+
 		case RC_LOADSESSION:
 			lexrc >> load_session;
 			break;
@@ -2144,6 +2149,14 @@ void LyXRC::write(ostream & os, bool ignore_system_lyxrc, string const & name) c
 		if (tag != RC_LAST)
 			break;
 		// fall through
+	case RC_UNDO_MEMORY_LIMIT:
+		if (ignore_system_lyxrc ||
+		    undo_memory_limit != system_lyxrc.undo_memory_limit) {
+			os << "\\undo_memory_limit " << undo_memory_limit << '\n';
+		}
+		if (tag != RC_LAST)
+			break;
+		// fall through
 	case RC_LOADSESSION:
 		if (ignore_system_lyxrc ||
 		    load_session != system_lyxrc.load_session) {
@@ -2919,6 +2932,7 @@ void actOnUpdatedPrefs(LyXRC const & lyxrc_orig, LyXRC const & lyxrc_new)
 	case LyXRC::RC_COMPLETION_POPUP_TEXT:
 	case LyXRC::RC_COMPLETION_MINLENGTH:
 	case LyXRC::RC_USELASTFILEPOS:
+	case LyXRC::RC_UNDO_MEMORY_LIMIT:
 	case LyXRC::RC_LOADSESSION:
 	case LyXRC::RC_CHKTEX_COMMAND:
 	case LyXRC::RC_CONVERTER:
@@ -3287,6 +3301,10 @@ string const LyXRC::getDescription(LyXRCTags tag)
 		str = _("De-select if you do not want LyX to scroll to saved position.");
 		break;
 
+	case RC_UNDO_MEMORY_LIMIT:
+		str = _("Maximal memory in MB used by the undo information of a document. Older undo steps are dropped when it is exceeded. Set to 0 for no limit.");
+		break;
+
 	case RC_LOADSESSION:
 		str = _("De-select to prevent loading files opened from the last LyX session.");
 		break;
@@ -3468,6 +3486,10 @@ string const LyXRC::getDescription(LyXRCTags tag)
 	case RC_USER_NAME:
 		break;
 
+	case RC_USE_CONVERTER_CACHE:
+		str = _("Cache the results of converters and of document exports. A cached export is reused as long as the document, its children, their layout and module files and the files referenced by insets are unchanged. Files that are read by LaTeX only, such as packages or files loaded with \\input in TeX code, are not checked.");
+		break;
+
 	case RC_USE_USE_SYSTEM_COLORS:
 		str = _("Enable use the system colors for some things like main window background and selection.");
 		break;
@@ -205,6 +205,24 @@ public:
 		return result;
 	}
 
+	/// \return the first position at or after \p pos that belongs
+	/// to a misspelled range, or -1 if there is none.
+	pos_type nextMisspelled(pos_type pos) const
+	{
+		pos_type result = -1;
+		RangesIterator et = ranges_.end();
+		RangesIterator it = ranges_.begin();
+		for (; it != et; ++it) {
+			if (!SpellChecker::misspelled(it->result())
+			    || it->range().last < pos)
+				continue;
+			pos_type const first = max(it->range().first, pos);
+			if (result == -1 || first < result)
+				result = first;
+		}
+		return result;
+	}
+
 	FontSpan const & getRange(pos_type pos) const
 	{
 		/// empty span to indicate mismatch
@@ -726,6 +744,12 @@ Change const & Paragraph::lookupChange(pos_type pos) const
 }
 
 
+Changes const & Paragraph::changes() const
+{
+	return d->changes_;
+}
+
+
 void Paragraph::acceptChanges(pos_type start, pos_type end)
 {
 	// Make sure that Buffer::hasChangesPresent is updated
@@ -1701,10 +1725,12 @@ void Paragraph::write(ostream & os, BufferParams const & bparams,
 	// to to_utf8(), which turn out to be expensive (JMarc)
 	docstring write_buffer;
 
+	Changes::Cursor change_cursor(d->changes_);
+	FontList::const_iterator font_it = d->fontlist_.begin();
 	int column = 0;
 	for (pos_type i = 0; i <= size(); ++i) {
 
-		Change const & change = lookupChange(i);
+		Change const & change = change_cursor.lookup(i);
 		if (change != running_change)
 			flushString(os, write_buffer);
 		Changes::lyxMarkChange(os, bparams, column, running_change, change);
@@ -1714,7 +1740,9 @@ void Paragraph::write(ostream & os, BufferParams const & bparams,
 			break;
 
 		// Write font changes
-		Font font2 = getFontSettings(bparams, i);
+		font_it = d->fontlist_.fontIterator(font_it, i);
+		Font font2 = font_it != d->fontlist_.end()
+			? font_it->font() : getFontSettings(bparams, i);
 		if (font2 != font1) {
 			flushString(os, write_buffer);
 			font2.lyxWriteChanges(font1, os);
@@ -1932,20 +1960,17 @@ FontSpan Paragraph::fontSpan(pos_type pos) const
 	if (pos == size())
 		return FontSpan(pos, pos);
 
-	pos_type start = 0;
-	FontList::const_iterator cit = d->fontlist_.begin();
-	FontList::const_iterator end = d->fontlist_.end();
-	for (; cit != end; ++cit) {
-		if (cit->pos() >= pos) {
-			if (pos >= beginOfBody())
-				return FontSpan(max(start, beginOfBody()),
-						cit->pos());
-			else
-				return FontSpan(start,
-						min(beginOfBody() - 1,
-							 cit->pos()));
-		}
-		start = cit->pos() + 1;
+	FontList::const_iterator cit = d->fontlist_.fontIterator(pos);
+	if (cit != d->fontlist_.end()) {
+		pos_type const start = cit == d->fontlist_.begin()
+			? 0 : prev(cit, 1)->pos() + 1;
+		if (pos >= beginOfBody())
+			return FontSpan(max(start, beginOfBody()),
+					cit->pos());
+		else
+			return FontSpan(start,
+					min(beginOfBody() - 1,
+						 cit->pos()));
 	}
 
 	// This should not happen, but if so, we take no chances.
@@ -2632,6 +2657,7 @@ void Paragraph::latex(BufferParams const & bparams,
 	// Yes if greater than 0. This has to be static.
 	THREAD_LOCAL_STATIC int parInline = 0;
 
+	Changes::Cursor change_cursor(d->changes_);
 	for (pos_type i = 0; i < size(); ++i) {
 		// First char in paragraph or after label?
 		if (i == body_pos) {
@@ -2675,7 +2701,7 @@ void Paragraph::latex(BufferParams const & bparams,
 		runparams.inDisplayMath = false;
 		bool deleted_display_math = false;
 		Change const & change = runparams.inDeletedInset
-			? runparams.changeOfDeletedInset : lookupChange(i);
+			? runparams.changeOfDeletedInset : change_cursor.lookup(i);
 
 		char_type const c = d->text_[i];
 
@@ -4192,6 +4218,13 @@ FontSpan const & Paragraph::getSpellRange(pos_type pos) const
 }
 
 
+pos_type Paragraph::nextMisspelled(pos_type pos) const
+{
+	pos_type const next = d->speller_state_.nextMisspelled(pos);
+	return next == -1 ? size() : next;
+}
+
+
 bool Paragraph::isChar(pos_type pos) const
 {
 	if (Inset const * inset = getInset(pos))
@@ -4777,6 +4810,10 @@ void Paragraph::locateWord(pos_type & from, pos_type & to,
 
 void Paragraph::collectWords()
 {
+	// The words are visited in increasing order of position, so the
+	// font list needs to be scanned only once.
+	FontList::const_iterator cit = d->fontlist_.begin();
+	FontList::const_iterator const cend = d->fontlist_.end();
 	for (pos_type pos = 0; pos < size(); ++pos) {
 		if (isWordSeparator(pos))
 			continue;
@@ -4793,8 +4830,9 @@ void Paragraph::collectWords()
 		pos_type const endpos = from + lyxrc.completion_minlength;
 		if (pos < endpos)
 			continue;
-		FontList::const_iterator cit = d->fontlist_.fontIterator(from);
-		if (cit == d->fontlist_.end())
+		while (cit != cend && cit->pos() < from)
+			++cit;
+		if (cit == cend)
 			return;
 		Language const * lang = cit->font().language();
 		docstring const word = asString(from, pos, AS_STR_NONE);
@@ -4819,9 +4857,29 @@ void Paragraph::registerWords()
 
 void Paragraph::updateWords()
 {
-	deregisterWords();
+	// Only the words that appeared or disappeared since the last call
+	// are passed to the word lists, usually most of them did not change.
+	Private::LangWordsMap old_words;
+	old_words.swap(d->words_);
 	collectWords();
-	registerWords();
+
+	Private::Words const none;
+	for (auto const & lw : old_words) {
+		Private::LangWordsMap::const_iterator const nit = d->words_.find(lw.first);
+		Private::Words const & now = nit == d->words_.end() ? none : nit->second;
+		WordList & wl = theWordList(lw.first);
+		for (docstring const & w : lw.second)
+			if (now.find(w) == now.end())
+				wl.remove(w);
+	}
+	for (auto const & lw : d->words_) {
+		Private::LangWordsMap::const_iterator const oit = old_words.find(lw.first);
+		Private::Words const & before = oit == old_words.end() ? none : oit->second;
+		WordList & wl = theWordList(lw.first);
+		for (docstring const & w : lw.second)
+			if (before.find(w) == before.end())
+				wl.insert(w);
+	}
 }
 
 
@@ -5102,14 +5160,20 @@ void Paragraph::Private::markMisspelledWords(
 }
 
 
-void Paragraph::spellCheck() const
+FontSpan Paragraph::spellCheck() const
 {
 	SpellChecker * speller = theSpellChecker();
-	if (!speller || empty() ||!needsSpellCheck())
-		return;
+	if (!speller || !needsSpellCheck())
+		return FontSpan();
+	if (empty()) {
+		// nothing to check until some text is inserted
+		d->readySpellCheck();
+		return FontSpan();
+	}
 	pos_type start;
 	pos_type endpos;
 	d->rangeOfSpellCheck(start, endpos);
+	FontSpan const checked(start, endpos);
 	if (speller->canCheckParagraph()) {
 		// loop until we leave the range
 		for (pos_type first = start; first < endpos; ) {
@@ -5137,6 +5201,7 @@ void Paragraph::spellCheck() const
 		}
 	}
 	d->readySpellCheck();
+	return checked;
 }
 
 
@@ -31,6 +31,7 @@ class AuthorList;
 class Buffer;
 class BufferParams;
 class Change;
+class Changes;
 class DocIterator;
 class docstring_list;
 class DocumentClass;
@@ -263,6 +264,9 @@ public:
 
 	/// look up change at given pos
 	Change const & lookupChange(pos_type pos) const;
+	/// the changes of the paragraph, e.g. to look them up with a
+	/// Changes::Cursor
+	Changes const & changes() const;
 
 	/// is there a change within the given range (does not
 	/// check contained paragraphs)
@@ -500,9 +504,15 @@ public:
 	/// Range is empty if word at position is correctly spelled.
 	FontSpan const & getSpellRange(pos_type pos) const;
 
+	/// \return the first position at or after \p pos that is known to
+	/// be misspelled, or size() if there is none. Only the results of
+	/// the last spellCheck() are taken into account.
+	pos_type nextMisspelled(pos_type pos) const;
+
 	/// spell check of whole paragraph
 	/// remember results until call of requestSpellCheck()
-	void spellCheck() const;
+	/// \return the range of positions that has been checked
+	FontSpan spellCheck() const;
 
 	/// query state of spell checker results
 	bool needsSpellCheck() const;
@@ -53,6 +53,7 @@ void PersonalWordList::load()
 
 	dirty(!words_.empty());
 	words_.clear();
+	index_.clear();
 	string line;
 	getline(ifs, line);
 	if (line == header()) {
@@ -90,27 +91,15 @@ void PersonalWordList::save()
 }
 
 
-bool PersonalWordList::equalwords(docstring const & w1, docstring const & w2) const
-{
-	return w1 == w2;
-}
-
-
 bool PersonalWordList::exists(docstring const & word) const
 {
-	docstring_list::const_iterator it = words_.begin();
-	docstring_list::const_iterator et = words_.end();
-	for (; it != et; ++it) {
-		if (equalwords(word,*it))
-			return true;
-	}
-	return false;
+	return index_.find(word) != index_.end();
 }
 
 
 void PersonalWordList::insert(docstring const & word)
 {
-	if (exists(word))
+	if (!index_.insert(word).second)
 		return;
 	words_.push_back(word);
 	dirty(true);
@@ -119,10 +108,12 @@ void PersonalWordList::insert(docstring const & word)
 
 void PersonalWordList::remove(docstring const & word)
 {
+	if (index_.erase(word) == 0)
+		return;
 	docstring_list::iterator it = words_.begin();
 	docstring_list::const_iterator et = words_.end();
 	for (; it != et; ++it) {
-		if (equalwords(word,*it)) {
+		if (*it == word) {
 			words_.erase(it);
 			dirty(true);
 			return;
@@ -17,6 +17,7 @@
 #include "support/FileName.h"
 
 #include <string>
+#include <unordered_set>
 
 namespace lyx {
 
@@ -46,13 +47,13 @@ public:
 private:
 	///
 	docstring_list words_;
+	/// the same words for fast lookup
+	std::unordered_set<docstring, docstring_hash> index_;
 	///
 	std::string lang_;
 	///
 	bool dirty_;
 	///
-	bool equalwords(docstring const & w1, docstring const & w2) const;
-	///
 	std::string header() const { return "# personal word list"; }
 	///
 	void dirty(bool flag) { dirty_ = flag; }
@@ -0,0 +1,131 @@
+/**
+ * \file SpellChecker.cpp
+ * This file is part of LyX, the document processor.
+ * Licence details can be found in the file COPYING.
+ *
+ * \author unknown
+ * \author John Levon
+ *
+ * Full author contact details are available in file CREDITS.
+ */
+
+#include <config.h>
+
+#include "SpellChecker.h"
+
+#include "Language.h"
+#include "WordLangTuple.h"
+
+#include "support/debug.h"
+
+#include <unordered_map>
+
+using namespace std;
+
+namespace lyx {
+
+namespace {
+
+/// maximal number of cached results per language
+size_t const max_cached_results = 50000;
+
+} // namespace
+
+
+class SpellChecker::ResultCache {
+public:
+	ResultCache() : change_number(0), hits(0), misses(0) {}
+	///
+	typedef unordered_map<docstring, Result, docstring_hash> Results;
+	///
+	struct LanguageResults {
+		/// Paragraph::Private::getSpellLanguage() may change the code
+		/// and variety of a language, which then need other results
+		bool matches(Language const * lang) const
+		{
+			return lang->code() == code && lang->variety() == variety;
+		}
+		///
+		string code;
+		///
+		string variety;
+		///
+		Results results;
+	};
+	/// the results per language
+	unordered_map<Language const *, LanguageResults> results;
+	/// the change number the results are valid for
+	ChangeNumber change_number;
+	///
+	unsigned long hits;
+	///
+	unsigned long misses;
+};
+
+
+SpellChecker::SpellChecker()
+	: change_number_(0), cache_(new ResultCache)
+{}
+
+
+SpellChecker::~SpellChecker()
+{
+	delete cache_;
+}
+
+
+unsigned long SpellChecker::cacheHits() const
+{
+	return cache_->hits;
+}
+
+
+unsigned long SpellChecker::cacheMisses() const
+{
+	return cache_->misses;
+}
+
+
+bool SpellChecker::cachedResult(WordLangTuple const & wl, Result & res) const
+{
+	if (cache_->change_number != change_number_) {
+		LYXERR(Debug::GUI, "spellcheck cache invalidated: "
+		       << cache_->hits << " hits, " << cache_->misses << " misses");
+		cache_->results.clear();
+		cache_->change_number = change_number_;
+	}
+	auto const lit = cache_->results.find(wl.lang());
+	if (lit != cache_->results.end() && lit->second.matches(wl.lang())) {
+		ResultCache::Results const & results = lit->second.results;
+		ResultCache::Results::const_iterator const it =
+			results.find(wl.word());
+		if (it != results.end()) {
+			++cache_->hits;
+			res = it->second;
+			return true;
+		}
+	}
+	++cache_->misses;
+	return false;
+}
+
+
+void SpellChecker::cacheResult(WordLangTuple const & wl, Result res) const
+{
+	// A missing dictionary is no result for the word
+	if (cache_->change_number != change_number_ || res == NO_DICTIONARY)
+		return;
+	ResultCache::LanguageResults & lres = cache_->results[wl.lang()];
+	if (!lres.matches(wl.lang())) {
+		lres.code = wl.lang()->code();
+		lres.variety = wl.lang()->variety();
+		lres.results.clear();
+	}
+	ResultCache::Results & results = lres.results;
+	// Keep the memory bounded; the frequent words come back quickly.
+	if (results.size() >= max_cached_results)
+		results.clear();
+	results[wl.word()] = res;
+}
+
+} // namespace lyx
@@ -21,6 +21,7 @@ namespace lyx {
 
 class BufferParams;
 class Language;
+class WordLangTable;
 class WordLangTuple;
 class docstring_list;
 
@@ -50,9 +51,9 @@ public:
 		NO_DICTIONARY
 	};
 
-	SpellChecker() : change_number_(0) {}
+	SpellChecker();
 
-	virtual ~SpellChecker() {}
+	virtual ~SpellChecker();
 
 	/// does the spell check failed
 	static bool misspelled(Result res) {
@@ -63,8 +64,9 @@ public:
 			&& res != DOCUMENT_LEARNED_WORD; }
 
 	/// check the given word of the given lang code and return the result
+	/// the second argument is the document dictionary
 	virtual enum Result check(WordLangTuple const &,
-				  std::vector<WordLangTuple> const &) = 0;
+				  WordLangTable const &) = 0;
 
 	/// Gives suggestions.
 	virtual void suggest(WordLangTuple const &, docstring_list & suggestions) = 0;
@@ -113,8 +115,30 @@ public:
 	void nextChangeNumber() { ++change_number_; }
 	virtual void advanceChangeNumber() = 0;
 
+	/// number of lookups answered by the result cache
+	unsigned long cacheHits() const;
+	/// number of lookups that had to ask the speller
+	unsigned long cacheMisses() const;
+
+protected:
+	/// Look up the result of an earlier check of \p wl, not taking
+	/// the document dictionary into account. All results are forgotten
+	/// when the change number advances.
+	/// \return false if \p wl has not been checked before
+	bool cachedResult(WordLangTuple const & wl, Result & res) const;
+	/// Remember the result \p res of checking \p wl
+	void cacheResult(WordLangTuple const & wl, Result res) const;
+
 private:
+	/// noncopyable
+	SpellChecker(SpellChecker const &);
+	void operator=(SpellChecker const &);
+
 	ChangeNumber change_number_;
+	///
+	class ResultCache;
+	///
+	ResultCache * const cache_;
 };
 
 /// Access to the singleton SpellChecker.
@@ -2796,7 +2796,7 @@ void Text::dispatch(Cursor & cur, FuncRequest & cmd)
 		WordLangTuple wl(word, language);
 		if (!bv->buffer().params().spellignored(wl)) {
 			cur.recordUndoBufferParams();
-			bv->buffer().params().spellignore().push_back(wl);
+			bv->buffer().params().spellignore().insert(wl);
 			cur.recordUndo();
 			// trigger re-check of whole buffer
 			bv->buffer().requestSpellcheck();
@@ -2818,19 +2818,9 @@ void Text::dispatch(Cursor & cur, FuncRequest & cmd)
 			}
 		}
 		WordLangTuple wl(word, language);
-		bool has_item = false;
-		vector<WordLangTuple>::const_iterator it = bv->buffer().params().spellignore().begin();
-		for (; it != bv->buffer().params().spellignore().end(); ++it) {
-			if (it->lang()->code() != wl.lang()->code())
-				continue;
-			if (it->word() == wl.word()) {
-				has_item = true;
-				break;
-			}
-		}
-		if (has_item) {
+		if (bv->buffer().params().spellignored(wl)) {
 			cur.recordUndoBufferParams();
-			bv->buffer().params().spellignore().erase(it);
+			bv->buffer().params().spellignore().erase(wl);
 			cur.recordUndo();
 			// trigger re-check of whole buffer
 			bv->buffer().requestSpellcheck();
@@ -22,6 +22,7 @@
 #include "Buffer.h"
 #include "BufferParams.h"
 #include "BufferView.h"
+#include "Changes.h"
 #include "CoordCache.h"
 #include "Cursor.h"
 #include "CutAndPaste.h"
@@ -157,6 +158,28 @@ void TextMetrics::setRowChanged(pit_type pit, pos_type pos)
 }
 
 
+bool TextMetrics::spellCheckNext()
+{
+	while (!spellcheck_pending_.empty()) {
+		pit_type const pit = *spellcheck_pending_.begin();
+		spellcheck_pending_.erase(spellcheck_pending_.begin());
+		ParMetricsCache::iterator const pmc_it = par_metrics_.find(pit);
+		if (pmc_it == par_metrics_.end()
+		    || pit >= pit_type(text_->paragraphs().size()))
+			continue;
+		Paragraph const & par = text_->getPar(pit);
+		if (!par.needsSpellCheck())
+			continue;
+		FontSpan const range = par.spellCheck();
+		for (Row & row : pmc_it->second.rows())
+			if (row.pos() <= range.last && row.endpos() >= range.first)
+				row.changed(true);
+		return true;
+	}
+	return false;
+}
+
+
 ParagraphMetrics & TextMetrics::parMetrics(pit_type pit, bool redo)
 {
 	ParMetricsCache::iterator pmc_it = par_metrics_.find(pit);
@@ -868,6 +891,7 @@ Row TextMetrics::tokenizeParagraph(pit_type const pit) const
 	// or the end of the par, then build a representation of the row.
 	pos_type i = 0;
 	FontIterator fi = FontIterator(*this, par, pit, 0);
+	Changes::Cursor change_cursor(par.changes());
 	// The real stopping condition is a few lines below.
 	while (true) {
 		// Firstly, check whether there is a bookmark here.
@@ -891,17 +915,17 @@ Row TextMetrics::tokenizeParagraph(pit_type const pit) const
 		if (par.isInset(i)) {
 			Inset const * ins = par.getInset(i);
 			Dimension dim = bv_->coordCache().insets().dim(ins);
-			row.add(i, ins, dim, *fi, par.lookupChange(i));
+			row.add(i, ins, dim, *fi, change_cursor.lookup(i));
 		} else if (c == ' ' && i + 1 == body_pos) {
 			// This space is an \item separator. Represent it with a
 			// special space element, which dimension will be computed
 			// in breakRow.
 			FontMetrics const & fm = theFontMetrics(text_->labelFont(par));
 			int const wid = fm.width(par.layout().labelsep);
-			row.addMarginSpace(i, wid, *fi, par.lookupChange(i));
+			row.addMarginSpace(i, wid, *fi, change_cursor.lookup(i));
 		} else if (c == '\t')
 			row.addSpace(i, theFontMetrics(*fi).width(from_ascii("    ")),
-			             *fi, par.lookupChange(i));
+			             *fi, change_cursor.lookup(i));
 		else if (c == 0x2028 || c == 0x2029) {
 			/**
 			 * U+2028 LINE SEPARATOR
@@ -917,10 +941,10 @@ Row TextMetrics::tokenizeParagraph(pit_type const pit) const
 			// ⤶ U+2936 ARROW POINTING DOWNWARDS THEN CURVING LEFTWARDS
 			// ¶ U+00B6 PILCROW SIGN
 			char_type const screen_char = (c == 0x2028) ? 0x2936 : 0x00B6;
-			row.add(i, screen_char, *fi, par.lookupChange(i));
+			row.add(i, screen_char, *fi, change_cursor.lookup(i));
 		} else
 			// row elements before body are unbreakable
-			row.add(i, c, *fi, par.lookupChange(i));
+			row.add(i, c, *fi, change_cursor.lookup(i));
 
 		// add inline completion width
 		// draw logically behind the previous character
@@ -2031,10 +2055,11 @@ void TextMetrics::drawParagraph(PainterInfo & pi, pit_type const pit, int const
 				row.change(row.end_margin_sel, sel_end.pit() > pit);
 		}
 
-		// Take this opportunity to spellcheck the row contents.
-		if (row.changed() && pi.do_spellcheck && lyxrc.spellcheck_continuously) {
-			text_->getPar(pit).spellCheck();
-		}
+		// Spellchecking the row contents is left to idle time (see
+		// spellCheckNext()), painting uses the results known so far.
+		if (row.changed() && pi.do_spellcheck && lyxrc.spellcheck_continuously
+		    && text_->getPar(pit).needsSpellCheck())
+			spellcheck_pending_.insert(pit);
 
 		RowPainter rp(pi, *text_, row, row_x, y);
 
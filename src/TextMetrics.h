@@ -22,6 +22,7 @@
 #include "support/types.h"
 
 #include <map>
+#include <set>
 
 namespace lyx {
 
@@ -55,6 +56,12 @@ public:
 	bool isFirstRow(Row const & row) const;
 	///
 	void setRowChanged(pit_type pit, pos_type pos);
+	/// Is there a painted paragraph whose spellchecking was postponed?
+	bool needsSpellCheck() const { return !spellcheck_pending_.empty(); }
+	/// Spellcheck the next paragraph whose spellchecking was postponed
+	/// and mark the rows that contain the checked range as changed.
+	/// \retval false if there is no such paragraph.
+	bool spellCheckNext();
 
 	///
 	Dimension const & dim() const { return dim_; }
@@ -252,6 +259,8 @@ private:
 	typedef std::map<pit_type, ParagraphMetrics> ParMetricsCache;
 	///
 	mutable ParMetricsCache par_metrics_;
+	/// Paragraphs that have been painted without being spellchecked
+	mutable std::set<pit_type> spellcheck_pending_;
 	Dimension dim_;
 	int max_width_;
 	/// if true, do not expand insets to max width artificially
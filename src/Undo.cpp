@@ -23,6 +23,8 @@
 #include "Cursor.h"
 #include "CutAndPaste.h"
 #include "ErrorList.h"
+#include "InsetList.h"
+#include "LyXRC.h"
 #include "Paragraph.h"
 #include "ParagraphList.h"
 #include "Text.h"
@@ -31,6 +33,7 @@
 #include "mathed/MathData.h"
 #include "mathed/MathRow.h"
 
+#include "insets/InsetTabular.h"
 #include "insets/InsetText.h"
 
 #include "support/debug.h"
@@ -47,6 +50,58 @@ using namespace lyx::support;
 
 namespace lyx {
 
+namespace {
+
+size_t memoryUse(ParagraphList const & pars);
+size_t memoryUse(MathData const & ar);
+
+
+/// Rough estimate of the memory used by the contents of \p inset
+size_t memoryUse(Inset const & inset)
+{
+	if (InsetText const * text = inset.asInsetText())
+		return memoryUse(text->paragraphs());
+	size_t mem = 0;
+	if (InsetTabular const * tabular = inset.asInsetTabular()) {
+		for (idx_type i = 0; i < tabular->nargs(); ++i)
+			mem += sizeof(InsetTableCell)
+				+ memoryUse(tabular->cell(i)->paragraphs());
+	} else if (InsetMath const * math = inset.asInsetMath()) {
+		for (idx_type i = 0; i < math->nargs(); ++i)
+			mem += memoryUse(math->cell(i));
+	}
+	return mem;
+}
+
+
+/// Rough estimate of the memory used by \p ar
+size_t memoryUse(MathData const & ar)
+{
+	// We do not know the real size of the insets, but most of them
+	// are small.
+	size_t mem = sizeof(MathData);
+	for (MathAtom const & at : ar)
+		mem += sizeof(MathAtom) + 8 * sizeof(void *) + memoryUse(*at.nucleus());
+	return mem;
+}
+
+
+/// Rough estimate of the memory used by \p pars
+size_t memoryUse(ParagraphList const & pars)
+{
+	// Same for the insets in the paragraphs
+	size_t mem = 0;
+	for (Paragraph const & par : pars) {
+		mem += sizeof(Paragraph) + par.size() * sizeof(char_type);
+		for (InsetList::Element const & elem : par.insetList())
+			mem += 16 * sizeof(void *) + memoryUse(*elem.inset);
+	}
+	return mem;
+}
+
+} // namespace
+
+
 /**
 These are the elements put on the undo stack. Each object contains
 complete paragraphs from some cell and sufficient information to
@@ -75,7 +130,7 @@ struct UndoElement
 	            pit_type fro, pit_type en, ParagraphList * pl, MathData * ar,
 	            bool lc, size_t gid) :
 		cur_before(cb), cell(cel), from(fro), end(en),
-		pars(pl), array(ar), bparams(nullptr),
+		pars(pl), array(ar), bparams(nullptr), memory(0),
 		group_id(gid), time(current_time()), kind(kin), lyx_clean(lc)
 		{}
 	///
@@ -83,6 +138,7 @@ struct UndoElement
 				bool lc, size_t gid) :
 		cur_before(cb), cell(), from(0), end(0),
 		pars(nullptr), array(nullptr), bparams(new BufferParams(bp)),
+		memory(sizeof(BufferParams)),
 		group_id(gid), time(current_time()), kind(ATOMIC_UNDO), lyx_clean(lc)
 	{}
 	///
@@ -91,7 +147,7 @@ struct UndoElement
 		cell(ue.cell), from(ue.from), end(ue.end),
 		pars(ue.pars), array(ue.array),
 		bparams(ue.bparams ? new BufferParams(*ue.bparams) : nullptr),
-		group_id(ue.group_id), time(current_time()), kind(ue.kind),
+		memory(ue.memory), group_id(ue.group_id), time(current_time()), kind(ue.kind),
 		lyx_clean(ue.lyx_clean)
 		{}
 	///
@@ -116,6 +172,8 @@ struct UndoElement
 	MathData * array;
 	/// Only used in case of params undo
 	BufferParams const * bparams;
+	/// estimated memory use of the saved contents
+	size_t memory;
 	/// the element's group id
 	size_t group_id;
 	/// timestamp
@@ -134,7 +192,7 @@ class UndoElementStack
 {
 public:
 	/// limit is the maximum size of the stack
-	UndoElementStack(size_t limit = 100) { limit_ = limit; }
+	UndoElementStack(size_t limit = 100) : limit_(limit), memory_(0) {}
 	/// limit is the maximum size of the stack
 	~UndoElementStack() { clear(); }
 
@@ -142,7 +200,10 @@ public:
 	UndoElement & top() { return c_.front(); }
 
 	/// Pop and throw away the top element.
-	void pop() { c_.pop_front(); }
+	void pop() {
+		memory_ -= c_.front().memory;
+		c_.pop_front();
+	}
 
 	/// Return true if the stack is empty.
 	bool empty() const { return c_.empty(); }
@@ -154,22 +215,33 @@ public:
 			delete c_[i].pars;
 		}
 		c_.clear();
+		memory_ = 0;
 	}
 
-	/// Push an item on to the stack, deleting the bottom group on
-	/// overflow.
+	/// Push an item on to the stack, deleting the bottom groups on
+	/// overflow. The stack overflows when it has too many elements,
+	/// or when the saved contents would use more memory than allowed
+	/// by lyxrc.undo_memory_limit (in MB, 0 means no limit).
 	void push(UndoElement const & v) {
-		// Remove some entries if the limit has been reached.
-		// However, if the only group on the stack is the one
-		// we are currently populating, do nothing.
-		if (c_.size() >= limit_
-		    && c_.front().group_id != v.group_id) {
-			// remove a whole group at once.
-			const size_t gid = c_.back().group_id;
-			while (!c_.empty() && c_.back().group_id == gid)
+		size_t const budget = lyxrc.undo_memory_limit > 0
+			? size_t(lyxrc.undo_memory_limit) << 20 : 0;
+		// Remove whole groups at once, but never the one we are
+		// currently populating.
+		while (!c_.empty() && c_.back().group_id != v.group_id
+		       && (c_.size() >= limit_
+		           || (budget && memory_ + v.memory > budget))) {
+			size_t const gid = c_.back().group_id;
+			while (!c_.empty() && c_.back().group_id == gid) {
+				memory_ -= c_.back().memory;
+				delete c_.back().array;
+				delete c_.back().pars;
 				c_.pop_back();
+			}
 		}
 		c_.push_front(v);
+		memory_ += v.memory;
+		LYXERR(Debug::UNDO, "Undo stack: " << c_.size() << " elements, "
+		       << memory_ << " bytes");
 	}
 
 	/// Mark all the elements of the stack as dirty
@@ -183,6 +255,8 @@ private:
 	std::deque<UndoElement> c_;
 	/// The maximum number elements stored.
 	size_t limit_;
+	/// Estimated memory use of the saved contents
+	size_t memory_;
 };
 
 
@@ -346,6 +420,7 @@ void Undo::Private::doRecordUndo(UndoKind kind,
 		// simply use the whole cell
 		MathData & ar = cell.cell();
 		undo.array = new MathData(ar.buffer(), ar.begin(), ar.end());
+		undo.memory = memoryUse(*undo.array);
 	} else {
 		// some more effort needed here as 'the whole cell' of the
 		// main Text _is_ the whole document.
@@ -358,6 +433,7 @@ void Undo::Private::doRecordUndo(UndoKind kind,
 		ParagraphList::const_iterator last = plist.begin();
 		advance(last, last_pit + 1);
 		undo.pars = new ParagraphList(first, last);
+		undo.memory = memoryUse(*undo.pars);
 	}
 
 	// push the undo entry to undo stack
@@ -0,0 +1,67 @@
+/**
+ * \file WordLangTuple.cpp
+ * This file is part of LyX, the document processor.
+ * Licence details can be found in the file COPYING.
+ *
+ * \author John Levon
+ *
+ * Full author contact details are available in file CREDITS.
+ */
+
+#include <config.h>
+
+#include "WordLangTuple.h"
+
+using namespace std;
+
+namespace lyx {
+
+
+bool WordLangTable::insert(WordLangTuple const & wl)
+{
+	if (contains(wl))
+		return false;
+	words_.push_back(wl);
+	index_.emplace(wl.word(), wl.lang()->code());
+	return true;
+}
+
+
+bool WordLangTable::erase(WordLangTuple const & wl)
+{
+	auto const range = index_.equal_range(wl.word());
+	for (auto it = range.first; it != range.second; ++it) {
+		if (it->second != wl.lang()->code())
+			continue;
+		index_.erase(it);
+		for (auto wit = words_.begin(); wit != words_.end(); ++wit) {
+			if (wit->word() == wl.word()
+			    && wit->lang()->code() == wl.lang()->code()) {
+				words_.erase(wit);
+				break;
+			}
+		}
+		return true;
+	}
+	return false;
+}
+
+
+void WordLangTable::clear()
+{
+	words_.clear();
+	index_.clear();
+}
+
+
+bool WordLangTable::contains(WordLangTuple const & wl) const
+{
+	auto const range = index_.equal_range(wl.word());
+	for (auto it = range.first; it != range.second; ++it)
+		if (it->second == wl.lang()->code())
+			return true;
+	return false;
+}
+
+
+} // namespace lyx
@@ -16,6 +16,8 @@
 
 #include "support/docstring.h"
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 
@@ -53,7 +55,40 @@ private:
 };
 
 
-typedef std::vector<WordLangTuple> WordLangTable;
+/**
+ * A list of words with their languages, such as the document dictionary.
+ * Words are kept in insertion order, lookup is done in a hash table.
+ * Two entries are the same if word and language code are equal.
+ */
+class WordLangTable {
+public:
+	///
+	typedef std::vector<WordLangTuple>::const_iterator const_iterator;
+	///
+	const_iterator begin() const { return words_.begin(); }
+	///
+	const_iterator end() const { return words_.end(); }
+	///
+	bool empty() const { return words_.empty(); }
+	///
+	size_t size() const { return words_.size(); }
+	/// add \p wl to the list
+	/// \return false if it was there already
+	bool insert(WordLangTuple const & wl);
+	/// remove \p wl from the list
+	/// \return false if it was not there
+	bool erase(WordLangTuple const & wl);
+	///
+	void clear();
+	/// is \p wl in the list?
+	bool contains(WordLangTuple const & wl) const;
+
+private:
+	///
+	std::vector<WordLangTuple> words_;
+	/// word -> language codes of the entries
+	std::unordered_multimap<docstring, std::string, docstring_hash> index_;
+};
 
 
 } // namespace lyx
@@ -48,6 +48,7 @@
 #undef KeyPress
 
 #include <algorithm>
+#include <map>
 #include <regex>
 #include <string>
 #include <vector>
@@ -763,6 +764,11 @@ void GuiCitation::init()
 	// Make the list of all available bibliography keys
 	BiblioInfo const & bi = bibInfo();
 	all_keys_ = to_qstring_list(bi.getKeys());
+	// The search index is rebuilt when it is needed
+	search_data_.clear();
+	search_pos_.clear();
+	search_words_.clear();
+	search_suffixes_.clear();
 
 	available_model_.setStringList(all_keys_);
 
@@ -1001,6 +1007,14 @@ vector<docstring> GuiCitation::searchKeys(BiblioInfo const & bi,
 	if (expr.empty())
 		return foundKeys;
 
+	if (!re && !only_keys && field.empty()) {
+		// This is the common case of typing in the filter field,
+		// which the search index has been made for.
+		if (search_pos_.empty())
+			buildSearchIndex(bi);
+		return searchIndex(keys_to_search, to_utf8(expr), case_sensitive);
+	}
+
 	if (!re)
 		// We must escape special chars in the search_expr so that
 		// it is treated as a simple string by regex.
@@ -1028,8 +1042,13 @@ vector<docstring> GuiCitation::searchKeys(BiblioInfo const & bi,
 		string sdata;
 		if (only_keys)
 			sdata = to_utf8(*it);
-		else if (field.empty())
-			sdata = to_utf8(*it) + ' ' + to_utf8(kvm.allData());
+		else if (field.empty()) {
+			auto const pit = search_pos_.find(*it);
+			if (pit != search_pos_.end())
+				sdata = search_data_[pit->second];
+			else
+				sdata = to_utf8(*it) + ' ' + to_utf8(kvm.allData());
+		}
 		else
 			sdata = to_utf8(kvm[field]);
 
@@ -1049,6 +1068,136 @@ vector<docstring> GuiCitation::searchKeys(BiblioInfo const & bi,
 }
 
 
+namespace {
+
+bool isWordChar(char c)
+{
+	return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z')
+		|| (c >= 'A' && c <= 'Z');
+}
+
+
+char lowercaseChar(char c)
+{
+	return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+}
+
+
+/// Split \p data into its words (maximal runs of ASCII letters and
+/// digits) and pass each of them, lowercased, to \p fun.
+template<typename Fun>
+void forEachWord(string const & data, Fun fun)
+{
+	size_t const n = data.size();
+	size_t i = 0;
+	while (i < n) {
+		while (i < n && !isWordChar(data[i]))
+			++i;
+		size_t const start = i;
+		while (i < n && isWordChar(data[i]))
+			++i;
+		if (i > start)
+			fun(ascii_lowercase(data.substr(start, i - start)));
+	}
+}
+
+
+/// Does \p data contain \p lower, which has to be lowercase, ignoring
+/// the case of ASCII letters? This is what icase regexes do.
+bool containsNoCase(string const & data, string const & lower)
+{
+	return search(data.begin(), data.end(), lower.begin(), lower.end(),
+		[](char a, char b) { return lowercaseChar(a) == b; }) != data.end();
+}
+
+} // namespace
+
+
+void GuiCitation::buildSearchIndex(BiblioInfo const & bi)
+{
+	search_data_.clear();
+	search_pos_.clear();
+	search_words_.clear();
+
+	map<string, vector<size_t>> words;
+	for (auto const & entry : bi) {
+		size_t const pos = search_data_.size();
+		search_pos_[entry.first] = pos;
+		search_data_.push_back(to_utf8(entry.first) + ' '
+			+ to_utf8(entry.second.allData()));
+		forEachWord(search_data_.back(), [&](string const & word) {
+			vector<size_t> & positions = words[word];
+			if (positions.empty() || positions.back() != pos)
+				positions.push_back(pos);
+		});
+	}
+	search_words_.reserve(words.size());
+	for (auto & word : words)
+		search_words_.push_back(make_pair(word.first, move(word.second)));
+
+	for (size_t i = 0; i < search_words_.size(); ++i)
+		for (size_t off = 0; off < search_words_[i].first.size(); ++off)
+			search_suffixes_.push_back(make_pair(unsigned(i), unsigned(off)));
+	sort(search_suffixes_.begin(), search_suffixes_.end(),
+	     [this](pair<unsigned int, unsigned int> const & a,
+	            pair<unsigned int, unsigned int> const & b) {
+		return search_words_[a.first].first.compare(a.second, string::npos,
+			search_words_[b.first].first, b.second, string::npos) < 0;
+	});
+	LYXERR(Debug::GUI, "GuiCitation: indexed " << search_data_.size()
+	       << " entries with " << search_words_.size() << " words");
+}
+
+
+vector<docstring> GuiCitation::searchIndex(vector<docstring> const & keys_to_search,
+	string const & expr, bool case_sensitive) const
+{
+	// Each word of the expression is part of a word of the matching
+	// data. Using the longest one, the words of the index tell which
+	// entries can possibly match, which saves scanning all the others.
+	string longest;
+	forEachWord(expr, [&](string const & word) {
+		if (word.size() > longest.size())
+			longest = word;
+	});
+	vector<bool> candidate;
+	if (!longest.empty()) {
+		candidate.resize(search_data_.size(), false);
+		// The words containing the expression word are those with a
+		// suffix that starts with it, as the plain search finds
+		// substrings. These suffixes are adjacent in search_suffixes_.
+		auto it = lower_bound(search_suffixes_.begin(), search_suffixes_.end(),
+			longest, [this](pair<unsigned int, unsigned int> const & suffix,
+			                string const & s) {
+				return search_words_[suffix.first].first.compare(
+					suffix.second, string::npos, s) < 0;
+			});
+		for (; it != search_suffixes_.end(); ++it) {
+			string const & word = search_words_[it->first].first;
+			if (word.compare(it->second, longest.size(), longest) != 0)
+				break;
+			for (size_t const pos : search_words_[it->first].second)
+				candidate[pos] = true;
+		}
+	}
+
+	string const lower = case_sensitive ? expr : ascii_lowercase(expr);
+	vector<docstring> foundKeys;
+	for (docstring const & key : keys_to_search) {
+		auto const it = search_pos_.find(key);
+		if (it == search_pos_.end())
+			continue;
+		if (!candidate.empty() && !candidate[it->second])
+			continue;
+		string const & data = search_data_[it->second];
+		if (case_sensitive ? data.find(expr) != string::npos
+		                   : containsNoCase(data, lower))
+			foundKeys.push_back(key);
+	}
+	return foundKeys;
+}
+
+
 void GuiCitation::dispatchParams()
 {
 	std::string const lfun = InsetCommand::params2string(params_);
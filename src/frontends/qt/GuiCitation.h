@@ -27,6 +27,11 @@
 #include <QStringList>
 #include <QStringListModel>
 
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace lyx {
 
 class CitationStyle;
@@ -160,6 +165,15 @@ private:
 		bool regex = false //< \set to true if \c search_expression is a regex
 		); //
 
+	/// Build the search index of all keys of \p bi.
+	void buildSearchIndex(BiblioInfo const & bi);
+	/// Search the literal UTF-8 string \p expr within the key and all
+	/// data of the passed keys, using the search index.
+	/// \return the vector of matched keys.
+	std::vector<docstring> searchIndex(
+		std::vector<docstring> const & keys_to_search,
+		std::string const & expr, bool case_sensitive) const;
+
 	/// The BibTeX information available to the dialog
 	/// Calls to this method will lead to checks of modification times and
 	/// the like, so it should be avoided.
@@ -189,6 +203,19 @@ private:
 	QStringList all_keys_;
 	/// Cited keys.
 	QStringList cited_keys_;
+	/// Search data (key and all BibTeX data, UTF-8 encoded) of all keys.
+	/// This is built on the first search after init().
+	std::vector<std::string> search_data_;
+	/// Position of the search data of each key in search_data_
+	std::unordered_map<docstring, size_t, docstring_hash> search_pos_;
+	/// The lowercase ASCII words of the search data, sorted, together
+	/// with the positions of the search data containing them.
+	std::vector<std::pair<std::string, std::vector<size_t>>> search_words_;
+	/// All suffixes of the words in search_words_ as pairs of the index
+	/// of the word and the start of the suffix, sorted by the suffix.
+	/// The words containing a string are found by a binary search for
+	/// the suffixes starting with it.
+	std::vector<std::pair<unsigned int, unsigned int>> search_suffixes_;
 	///
 	InsetCommandParams params_;
 };
@@ -2143,7 +2143,8 @@ void GuiView::structureChanged()
 	if (documentBufferView())
 		documentBufferView()->cursor().sanitize();
 	// FIXME: This is slightly expensive, though less than the tocBackend update
-	// (#9880). This also resets the view in the Toc Widget (#6675).
+	// (#9880). The models are updated in place when only some items changed,
+	// otherwise this also resets the view in the Toc Widget (#6675).
 	d.toc_models_.reset(documentBufferView());
 	// Navigator needs more than a simple update in this case. It needs to be
 	// rebuilt.
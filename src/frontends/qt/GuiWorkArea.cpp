@@ -54,6 +54,7 @@
 
 #include <QContextMenuEvent>
 #include <QDrag>
+#include <QElapsedTimer>
 #include <QHelpEvent>
 #ifdef Q_OS_MAC
 #include <QProxyStyle>
@@ -82,6 +83,11 @@ using namespace lyx::support;
 
 namespace lyx {
 
+/// delay in ms between painting and continuous spellchecking
+static int const spellcheck_interval = 10;
+/// time in ms spent spellchecking before processing events again
+static int const spellcheck_slice = 30;
+
 
 /// return the LyX mouse button state from Qt's
 static mouse_button::state q_button_state(Qt::MouseButton button)
@@ -189,6 +195,11 @@ void GuiWorkArea::init()
 	connect(&d->caret_timeout_, SIGNAL(timeout()),
 		this, SLOT(toggleCaret()));
 
+	d->spellcheck_timeout_.setSingleShot(true);
+	d->spellcheck_timeout_.setInterval(spellcheck_interval);
+	connect(&d->spellcheck_timeout_, SIGNAL(timeout()),
+		this, SLOT(spellCheckIdle()));
+
 	// This connection is closed at the same time as this is destroyed.
 	d->synthetic_mouse_event_.timeout.timeout.connect([this](){
 			generateSyntheticMouseEvent();
@@ -338,6 +349,32 @@ void GuiWorkArea::toggleCaret()
 }
 
 
+void GuiWorkArea::spellCheckIdle()
+{
+	// Do not touch the paragraphs in the middle of a dispatch operation
+	if (view().busy() || d->buffer_view_->buffer().undo().activeUndoGroup()) {
+		d->spellcheck_timeout_.start();
+		return;
+	}
+
+	// Check paragraph after paragraph for a slice of time, then give
+	// the event loop a chance to process user input.
+	QElapsedTimer timer;
+	timer.start();
+	bool checked = false;
+	while (d->buffer_view_->spellCheckNext()) {
+		checked = true;
+		if (timer.elapsed() >= spellcheck_slice) {
+			d->spellcheck_timeout_.start();
+			break;
+		}
+	}
+	// Repaint the rows with new results
+	if (checked)
+		viewport()->update();
+}
+
+
 void GuiWorkArea::scheduleRedraw(bool update_metrics)
 {
 	if (!isVisible())
@@ -1281,6 +1318,10 @@ void GuiWorkArea::paintEvent(QPaintEvent * ev)
 
 	d->updateScreen(ev->rect());
 
+	// Spellcheck the paragraphs that have been painted unchecked
+	if (d->buffer_view_->needsSpellCheck() && !d->spellcheck_timeout_.isActive())
+		d->spellcheck_timeout_.start();
+
 	ev->accept();
 }
 
@@ -116,6 +116,8 @@ private Q_SLOTS:
 	void close() override;
 	/// Slot to restore proper scrollbar behaviour.
 	void fixVerticalScrollBar();
+	/// spellcheck the painted paragraphs for a slice of time
+	void spellCheckIdle();
 
 private:
 	/// Update window titles of all users.
@@ -127,6 +127,8 @@ struct GuiWorkArea::Private
 	bool needs_caret_geometry_update_ = true;
 	///
 	QTimer caret_timeout_;
+	/// runs the continuous spellchecking after painting
+	QTimer spellcheck_timeout_;
 
 	///
 	SyntheticMouseEvent synthetic_mouse_event_;
@@ -30,6 +30,9 @@
 
 
 #include <climits>
+#include <functional>
+#include <utility>
+#include <vector>
 
 using namespace std;
 
@@ -160,8 +163,114 @@ void TocModel::updateItem(DocIterator const & dit)
 }
 
 
+namespace {
+
+/// Whether two items are displayed the same way
+bool sameDisplay(TocItem const & a, TocItem const & b)
+{
+	return a.depth() == b.depth() && a.isOutput() == b.isOutput()
+		&& a.asString() == b.asString();
+}
+
+
+/// Whether all items of \p toc have depth \p depth
+bool isFlat(Toc const & toc, int depth)
+{
+	for (TocItem const & item : toc)
+		if (item.depth() != depth)
+			return false;
+	return true;
+}
+
+} // namespace
+
+
+bool TocModel::updateInPlace(shared_ptr<Toc const> toc)
+{
+	// Keep the old list alive while comparing
+	shared_ptr<Toc const> const old_toc_ptr = toc_;
+	Toc const & old_toc = *old_toc_ptr;
+	Toc const & new_toc = *toc;
+	if (old_toc.empty() || new_toc.empty() || model_->columnCount() == 0)
+		return false;
+
+	size_t const old_size = old_toc.size();
+	size_t const new_size = new_toc.size();
+	bool same_depths = old_size == new_size;
+	for (size_t i = 0; same_depths && i != old_size; ++i)
+		same_depths = old_toc[i].depth() == new_toc[i].depth();
+
+	if (same_depths) {
+		// The tree is unchanged. The rows of the model are the
+		// items in depth-first order, see reset().
+		vector<QModelIndex> rows;
+		rows.reserve(old_size);
+		function<void(QModelIndex const &)> collect =
+			[&](QModelIndex const & parent) {
+			int const count = model_->rowCount(parent);
+			for (int row = 0; row != count; ++row) {
+				QModelIndex const index = model_->index(row, 0, parent);
+				rows.push_back(index);
+				collect(index);
+			}
+		};
+		collect(QModelIndex());
+		if (rows.size() != old_size)
+			return false;
+		toc_ = toc;
+		for (size_t i = 0; i != old_size; ++i)
+			if (!sameDisplay(old_toc[i], new_toc[i]))
+				setString(new_toc[i], rows[i]);
+		return true;
+	}
+
+	// Items have been inserted or removed. This is handled for lists
+	// without hierarchy (e.g. the lists of floats or labels), whose rows
+	// correspond directly to the items.
+	int const depth = old_toc.front().depth();
+	if (!isFlat(old_toc, depth) || !isFlat(new_toc, depth)
+	    || model_->rowCount() != int(old_size))
+		return false;
+
+	size_t const common = min(old_size, new_size);
+	size_t prefix = 0;
+	while (prefix != common && sameDisplay(old_toc[prefix], new_toc[prefix]))
+		++prefix;
+	size_t suffix = 0;
+	while (suffix != common - prefix
+	       && sameDisplay(old_toc[old_size - suffix - 1],
+	                      new_toc[new_size - suffix - 1]))
+		++suffix;
+
+	toc_ = toc;
+	int const first = int(prefix);
+	int const removed = int(old_size - prefix - suffix);
+	int const inserted = int(new_size - prefix - suffix);
+	if (removed > 0)
+		model_->removeRows(first, removed);
+	if (inserted > 0)
+		model_->insertRows(first, inserted);
+	for (int row = first; row != first + inserted; ++row) {
+		QModelIndex const index = model_->index(row, 0);
+		setString(new_toc[size_t(row)], index);
+		model_->setData(index, row, Qt::UserRole);
+	}
+	// The rows after the change refer to other items now
+	if (removed != inserted)
+		for (int row = first + inserted; row != int(new_size); ++row)
+			model_->setData(model_->index(row, 0), row, Qt::UserRole);
+	LYXERR(Debug::GUI, "Toc: removed " << removed << " and inserted "
+	       << inserted << " items at row " << first);
+	return true;
+}
+
+
 void TocModel::reset(shared_ptr<Toc const> toc)
 {
+	if (updateInPlace(toc))
+		return;
+
+	clear();
 	toc_ = toc;
 	if (toc_->empty()) {
 		maxdepth_ = 0;
@@ -351,8 +460,8 @@ TocModels::~TocModels(){
 
 void TocModels::reset(BufferView const * bv)
 {
-	clear();
 	if (!bv) {
+		clear();
 		iterator end = models_.end();
 		for (iterator it = models_.begin(); it != end;  ++it)
 			it.value()->reset();
@@ -360,27 +469,49 @@ void TocModels::reset(BufferView const * bv)
 		return;
 	}
 
-	names_->blockSignals(true);
-	names_->beginResetModel();
-	names_->insertColumns(0, 1);
 	// In the outliner, add Tocs from the master document
 	TocBackend const & backend = bv->buffer().masterBuffer()->tocBackend();
+	// The toc models are updated in place where possible, so that the
+	// views keep their state.
+	vector<pair<QString, QString>> names;
 	for (auto const & toc : backend.tocs()) {
 		QString const type = toqstr(toc.first);
-
-		// First, fill in the toc models.
 		iterator mod_it = models_.find(type);
 		if (mod_it == models_.end())
 			mod_it = models_.insert(type, new TocModel(this));
 		mod_it.value()->reset(toc.second);
+		names.push_back(make_pair(type, toqstr(backend.outlinerName(toc.first))));
+	}
+	// Empty the models of lists that do not exist anymore
+	for (iterator it = models_.begin(); it != models_.end(); ++it)
+		if (backend.tocs().find(fromqstr(it.key())) == backend.tocs().end()
+		    && !it.value()->empty()) {
+			it.value()->clear();
+			it.value()->reset();
+		}
+
+	// The list of names only changes when a list is added or removed
+	bool same_names = names_->columnCount() == 1
+		&& names_->rowCount() == int(names.size());
+	for (int row = 0; same_names && row != names_->rowCount(); ++row) {
+		QModelIndex const index = names_->index(row, 0);
+		same_names = index.data(Qt::UserRole).toString() == names[size_t(row)].first
+			&& index.data(Qt::DisplayRole).toString() == names[size_t(row)].second;
+	}
+	if (same_names)
+		return;
 
+	names_->blockSignals(true);
+	names_->clear();
+	names_->beginResetModel();
+	names_->insertColumns(0, 1);
+	for (auto const & name : names) {
 		// Fill in the names_ model.
-		QString const gui_name = toqstr(backend.outlinerName(toc.first));
 		int const current_row = names_->rowCount();
 		names_->insertRows(current_row, 1);
 		QModelIndex const index = names_->index(current_row, 0);
-		names_->setData(index, gui_name, Qt::DisplayRole);
-		names_->setData(index, type, Qt::UserRole);
+		names_->setData(index, name.second, Qt::DisplayRole);
+		names_->setData(index, name.first, Qt::UserRole);
 	}
 	names_->blockSignals(false);
 	names_->endResetModel();
@@ -64,6 +64,11 @@ public:
 	int modelDepth() const;
 
 private:
+	/// Adapt the model to \p toc without resetting it, if only the
+	/// strings of the items changed or items were inserted into or
+	/// removed from a flat list.
+	/// \return false if the model needs to be reset.
+	bool updateInPlace(std::shared_ptr<Toc const> toc);
 	///
 	void populate(unsigned int & index, QModelIndex const & parent);
 	///
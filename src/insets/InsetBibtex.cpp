@@ -14,6 +14,7 @@
 
 #include "InsetBibtex.h"
 
+#include "BibFileCache.h"
 #include "BiblioInfo.h"
 #include "Buffer.h"
 #include "BufferParams.h"
@@ -48,9 +49,13 @@
 #include "support/PathChanger.h"
 #include "support/textutils.h"
 
-#include <limits>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <iterator>
 #include <map>
 #include <regex>
+#include <thread>
 #include <utility>
 
 #include <iostream>
@@ -421,11 +426,52 @@ namespace {
 
 	typedef map<docstring, docstring> VarMap;
 
+	/// The parts of the ifdocstream interface used by the parser below,
+	/// working on the whole database read into memory at once. This is
+	/// much faster than going through the stream for each character.
+	class BibTeXStream {
+	public:
+		///
+		explicit BibTeXStream(docstring const & s)
+			: s_(s), pos_(0), fail_(false)
+		{}
+		///
+		explicit operator bool() const { return !fail_; }
+		///
+		void get(char_type & ch)
+		{
+			if (fail_ || pos_ >= s_.size()) {
+				fail_ = true;
+				return;
+			}
+			ch = s_[pos_++];
+		}
+		///
+		void putback(char_type)
+		{
+			if (!fail_ && pos_ > 0)
+				--pos_;
+		}
+		/// skip everything up to and including \p delim
+		void ignore(char_type delim)
+		{
+			size_t const pos = s_.find(delim, pos_);
+			pos_ = pos == docstring::npos ? s_.size() : pos + 1;
+		}
+	private:
+		///
+		docstring const & s_;
+		///
+		size_t pos_;
+		///
+		bool fail_;
+	};
+
 	/// remove whitespace characters, optionally a single comma,
 	/// and further whitespace characters from the stream.
 	/// @return true if a comma was found, false otherwise
 	///
-	bool removeWSAndComma(ifdocstream & ifs) {
+	bool removeWSAndComma(BibTeXStream & ifs) {
 		char_type ch;
 
 		if (!ifs)
@@ -468,7 +514,7 @@ namespace {
 	///
 	/// @return true if a string of length > 0 could be read.
 	///
-	bool readTypeOrKey(docstring & val, ifdocstream & ifs,
+	bool readTypeOrKey(docstring & val, BibTeXStream & ifs,
 		docstring const & delimChars, docstring const & illegalChars,
 		charCase chCase) {
 
@@ -521,7 +567,7 @@ namespace {
 	/// the variable strings.
 	/// @return true if reading was successful (all single parts were delimited
 	/// correctly)
-	bool readValue(docstring & val, ifdocstream & ifs, const VarMap & strings) {
+	bool readValue(docstring & val, BibTeXStream & ifs, const VarMap & strings) {
 
 		char_type ch;
 
@@ -651,60 +697,40 @@ namespace {
 
 		return true;
 	}
-} // namespace
-
-
-void InsetBibtex::collectBibKeys(InsetIterator const & /*di*/, FileNameList & checkedFiles) const
-{
-	parseBibTeXFiles(checkedFiles);
-}
-
-
-void InsetBibtex::parseBibTeXFiles(FileNameList & checkedFiles) const
-{
-	// This bibtex parser is a first step to parse bibtex files
-	// more precisely.
-	//
-	// - it reads the whole bibtex entry and does a syntax check
-	//   (matching delimiters, missing commas,...
-	// - it recovers from errors starting with the next @-character
-	// - it reads @string definitions and replaces them in the
-	//   field values.
-	// - it accepts more characters in keys or value names than
-	//   bibtex does.
-	//
-	// Officially bibtex does only support ASCII, but in practice
-	// you can use any encoding as long as some elements like keys
-	// and names are pure ASCII. We support specifying an encoding,
-	// and we convert the file from that (default is buffer encoding).
-	// We don't restrict keys to ASCII in LyX, since our own
-	// InsetBibitem can generate non-ASCII keys, and nonstandard
-	// 8bit clean bibtex forks exist.
 
-	BiblioInfo keylist;
-
-	docstring_list const files = getBibFiles();
-	for (auto const & bf : files) {
-		FileName const bibfile = buffer().getBibfilePath(bf);
-		if (bibfile.empty()) {
-			LYXERR0("Unable to find path for " << bf << "!");
-			continue;
+	/// Parses the BibTeX database \p bibfile, read with \p encoding.
+	/// This does not touch any buffer, so that it can run in a thread.
+	BiblioInfo parseBibTeXFile(FileName const & bibfile, string const & encoding)
+	{
+		// This bibtex parser is a first step to parse bibtex files
+		// more precisely.
+		//
+		// - it reads the whole bibtex entry and does a syntax check
+		//   (matching delimiters, missing commas,...
+		// - it recovers from errors starting with the next @-character
+		// - it reads @string definitions and replaces them in the
+		//   field values.
+		// - it accepts more characters in keys or value names than
+		//   bibtex does.
+		//
+		// Officially bibtex does only support ASCII, but in practice
+		// you can use any encoding as long as some elements like keys
+		// and names are pure ASCII. We support specifying an encoding,
+		// and we convert the file from that (default is buffer encoding).
+		// We don't restrict keys to ASCII in LyX, since our own
+		// InsetBibitem can generate non-ASCII keys, and nonstandard
+		// 8bit clean bibtex forks exist.
+
+		BiblioInfo keylist;
+
+		docstring content;
+		{
+			ifdocstream ifs(bibfile.toFilesystemEncoding().c_str(),
+				ios_base::in, encoding);
+			content.assign(istreambuf_iterator<char_type>(ifs),
+				       istreambuf_iterator<char_type>());
 		}
-		if (find(checkedFiles.begin(), checkedFiles.end(), bibfile) != checkedFiles.end())
-			// already checked this one. Skip.
-			continue;
-		else
-			// record that we check this.
-			checkedFiles.push_back(bibfile);
-		string encoding = buffer().masterParams().encoding().iconvName();
-		string ienc = buffer().masterParams().bibFileEncoding(to_utf8(bf));
-		if (ienc.empty() || ienc == "general")
-			ienc = to_ascii(params()["encoding"]);
-
-		if (!ienc.empty() && ienc != "auto-legacy-plain" && ienc != "auto-legacy" && encodings.fromLyXName(ienc))
-			encoding = encodings.fromLyXName(ienc)->iconvName();
-		ifdocstream ifs(bibfile.toFilesystemEncoding().c_str(),
-			ios_base::in, encoding);
+		BibTeXStream ifs(content);
 
 		char_type ch;
 		VarMap strings;
@@ -730,7 +756,7 @@ void InsetBibtex::parseBibTeXFiles(FileNameList & checkedFiles) const
 			}
 
 			if (entryType == from_ascii("comment")) {
-				ifs.ignore(numeric_limits<int>::max(), '\n');
+				ifs.ignore('\n');
 				continue;
 			}
 
@@ -809,12 +835,12 @@ void InsetBibtex::parseBibTeXFiles(FileNameList & checkedFiles) const
 
 				/////////////////////////////////////////////
 				// now we have a key, so we will add an entry
- 				// (even if it's empty, as bibtex does)
+				// (even if it's empty, as bibtex does)
 				//
 				// we now read the field = value pairs.
- 				// all items must be separated by a comma. If
- 				// it is missing the scanning of this entry is
- 				// stopped and the next is searched.
+				// all items must be separated by a comma. If
+				// it is missing the scanning of this entry is
+				// stopped and the next is searched.
 				docstring name;
 				docstring value;
 				docstring data;
@@ -862,7 +888,82 @@ void InsetBibtex::parseBibTeXFiles(FileNameList & checkedFiles) const
 				keylist[key] = keyvalmap;
 			} //< else (citation entry)
 		} //< searching '@'
-	} //< for loop over files
+		return keylist;
+	}
+} // namespace
+
+
+void InsetBibtex::collectBibKeys(InsetIterator const & /*di*/, FileNameList & checkedFiles) const
+{
+	parseBibTeXFiles(checkedFiles);
+}
+
+
+void InsetBibtex::parseBibTeXFiles(FileNameList & checkedFiles) const
+{
+	vector<pair<FileName, string>> databases;
+	docstring_list const files = getBibFiles();
+	for (auto const & bf : files) {
+		FileName const bibfile = buffer().getBibfilePath(bf);
+		if (bibfile.empty()) {
+			LYXERR0("Unable to find path for " << bf << "!");
+			continue;
+		}
+		if (find(checkedFiles.begin(), checkedFiles.end(), bibfile) != checkedFiles.end())
+			// already checked this one. Skip.
+			continue;
+		else
+			// record that we check this.
+			checkedFiles.push_back(bibfile);
+		string encoding = buffer().masterParams().encoding().iconvName();
+		string ienc = buffer().masterParams().bibFileEncoding(to_utf8(bf));
+		if (ienc.empty() || ienc == "general")
+			ienc = to_ascii(params()["encoding"]);
+
+		if (!ienc.empty() && ienc != "auto-legacy-plain" && ienc != "auto-legacy" && encodings.fromLyXName(ienc))
+			encoding = encodings.fromLyXName(ienc)->iconvName();
+		databases.push_back(make_pair(bibfile, encoding));
+	}
+
+	// Unchanged databases are taken from the cache, the others are
+	// parsed, in parallel if there are several of them.
+	BibFileCache const & cache = BibFileCache::get();
+	vector<BiblioInfo> infos(databases.size());
+	vector<size_t> missing;
+	for (size_t i = 0; i < databases.size(); ++i)
+		if (!cache.find(databases[i].first, databases[i].second, infos[i]))
+			missing.push_back(i);
+	if (missing.size() > 1) {
+		// Use at most one thread per core. Each thread takes the
+		// next database that nobody parses yet.
+		size_t const nthreads = min(missing.size(),
+			size_t(max(1u, thread::hardware_concurrency())));
+		atomic<size_t> next(0);
+		auto parseMissing = [&]() {
+			for (size_t k = next++; k < missing.size(); k = next++) {
+				size_t const i = missing[k];
+				infos[i] = parseBibTeXFile(databases[i].first,
+							   databases[i].second);
+			}
+		};
+		vector<future<void>> workers;
+		for (size_t t = 1; t < nthreads; ++t)
+			workers.push_back(async(launch::async, parseMissing));
+		parseMissing();
+		for (future<void> & worker : workers)
+			worker.get();
+	} else {
+		for (size_t const i : missing)
+			infos[i] = parseBibTeXFile(databases[i].first, databases[i].second);
+	}
+	for (size_t const i : missing)
+		cache.add(databases[i].first, databases[i].second, infos[i]);
+
+	// mergeBiblioInfo() keeps the first entry of a key, but entries of
+	// later databases replace those of earlier ones.
+	BiblioInfo keylist;
+	for (size_t i = infos.size(); i > 0; --i)
+		keylist.mergeBiblioInfo(infos[i - 1]);
 
 	buffer().addBiblioInfo(keylist);
 }
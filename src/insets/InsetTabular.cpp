@@ -843,14 +843,17 @@ void Tabular::appendRow(row_type row)
 void Tabular::insertRow(row_type const row, bool copy)
 {
 	row_info.insert(row_info.begin() + row + 1, row_info[row]);
-	cell_info.insert(cell_info.begin() + row + 1,
-		cell_vector(0, CellData(buffer_)));
+	cell_info.insert(cell_info.begin() + row + 1, cell_vector());
 
+	cell_vector & new_row = cell_info[row + 1];
+	new_row.reserve(ncols());
 	for (col_type c = 0; c < ncols(); ++c) {
-		cell_info[row + 1].insert(cell_info[row + 1].begin() + c,
-			copy ? cell_info[row][c] : CellData(buffer_));
+		if (copy)
+			new_row.push_back(cell_info[row][c]);
+		else
+			new_row.push_back(CellData(buffer_));
 		if (cell_info[row][c].multirow == CELL_BEGIN_OF_MULTIROW)
-			cell_info[row + 1][c].multirow = CELL_PART_OF_MULTIROW;
+			new_row[c].multirow = CELL_PART_OF_MULTIROW;
 	}
 
 	updateIndexes();
@@ -4734,8 +4737,17 @@ void InsetTabular::draw(PainterInfo & pi, int x, int y) const
 	// Save tabular change status
 	Change tab_change = pi.change;
 
+	// The positions of the cells have been set in the nodraw stage,
+	// which draws everything. On screen, it is enough to draw the rows
+	// that are visible, which matters for long tables.
+	bool const on_screen = !pi.pain.isNull();
+	int const wh = bv->workHeight();
+
 	int yy = y + tabular.offsetVAlignment();
 	for (row_type r = 0; r < tabular.nrows(); ++r) {
+		bool const row_visible = !on_screen
+			|| (yy + tabular.rowDescent(r) >= 0
+			    && yy - tabular.rowAscent(r) < wh);
 		int nx = x;
 		for (col_type c = 0; c < tabular.ncols(); ++c) {
 			if (tabular.isPartOfMultiColumn(r, c))
@@ -4748,6 +4760,12 @@ void InsetTabular::draw(PainterInfo & pi, int x, int y) const
 				continue;
 			}
 
+			// A multirow cell extends into the following rows
+			if (!row_visible && !tabular.isMultiRow(idx)) {
+				nx += tabular.cellWidth(idx);
+				continue;
+			}
+
 			pi.selected |= isCellSelected(cur, r, c);
 
 			// Mark deleted rows/columns
@@ -725,10 +725,15 @@ public:
 	public:
 		///
 		explicit CellData(Buffer *);
-		///
+		/// The copy gets a clone of the cell inset
 		CellData(CellData const &);
 		///
 		CellData & operator=(CellData const &);
+		/// Moving keeps the cell inset. This makes shifting and
+		/// swapping cells cheap, since no cell contents are cloned.
+		CellData(CellData &&) = default;
+		///
+		CellData & operator=(CellData &&) = default;
 		///
 		idx_type cellno;
 		///
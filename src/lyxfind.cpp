@@ -26,6 +26,7 @@
 #include "Cursor.h"
 #include "CutAndPaste.h"
 #include "FuncRequest.h"
+#include "InsetList.h"
 #include "LyX.h"
 #include "output_latex.h"
 #include "OutputParams.h"
@@ -390,6 +391,7 @@ bool findOne(BufferView * bv, docstring const & searchstr,
 
 namespace {
 
+/// Returns the number of replacements, or -1 if the user cancelled
 int replaceAll(BufferView * bv,
 	       docstring const & searchstr, docstring const & replacestr,
 	       bool case_sens, bool whole, bool onlysel)
@@ -404,48 +406,74 @@ int replaceAll(BufferView * bv,
 	bool const had_selection = bv->cursor().selection();
 
 	MatchString const match(searchstr, case_sens, whole);
-	int num = 0;
 
 	int const rsize = replacestr.size();
 	int const ssize = searchstr.size();
 
-	Cursor cur(*bv);
-	cur.setCursor(doc_iterator_begin(&buf));
-	int match_len = findForward(cur, endcur, match, false, onlysel);
+	bool const own_long_operation = !theApp()->longOperationStarted();
+	if (own_long_operation)
+		theApp()->startLongOperation();
+
+	// First collect all matches. Nothing is changed yet, so that the
+	// iterators remain valid.
+	vector<pair<DocIterator, int>> matches;
+	bool cancelled = false;
+	DocIterator it = doc_iterator_begin(&buf);
+	int match_len = findForward(it, endcur, match, false, onlysel);
 	while (match_len > 0) {
-		// Backup current cursor position and font.
+		matches.push_back(make_pair(it, match_len));
+		if (matches.size() % 1000 == 0) {
+			if (theApp()->longOperationCancelled()) {
+				matches.clear();
+				cancelled = true;
+				buf.message(_("Replace cancelled by user."));
+				break;
+			}
+			buf.message(bformat(_("%1$d matches found..."),
+					    int(matches.size())));
+		}
+		// A match may span character and letter insets, but it
+		// always lies within one paragraph and match_len is the
+		// number of positions it spans, so this steps behind it.
+		it.pos() += match_len;
+		match_len = findForward(it, endcur, match, false, onlysel);
+	}
+
+	if (own_long_operation)
+		theApp()->stopLongOperation();
+
+	// Then replace them back to front, so that the positions of the
+	// matches that are still to be replaced do not change. Undo is
+	// recorded once per paragraph, not once per match.
+	Cursor cur(*bv);
+	Paragraph const * recorded = nullptr;
+	int endcur_shift = 0;
+	vector<pair<DocIterator, int>>::const_reverse_iterator rit = matches.rbegin();
+	vector<pair<DocIterator, int>>::const_reverse_iterator const rend = matches.rend();
+	for (; rit != rend; ++rit) {
+		cur.setCursor(rit->first);
+		Paragraph & par = cur.paragraph();
+		if (&par != recorded) {
+			cur.recordUndo();
+			recorded = &par;
+		}
 		pos_type const pos = cur.pos();
-		Font const font = cur.paragraph().getFontSettings(buf.params(), pos);
-		cur.recordUndo();
+		Font const font = par.getFontSettings(buf.params(), pos);
 		int ct_deleted_text = ssize -
-			cur.paragraph().eraseChars(pos, pos + match_len,
-						   buf.params().track_changes);
-		cur.paragraph().insert(pos, replacestr, font,
-				       Change(buf.params().track_changes
-					      ? Change::INSERTED
-					      : Change::UNCHANGED));
-		for (int i = 0; i < rsize + ct_deleted_text
-		     && cur.pos() < cur.lastpos(); ++i)
-			cur.forwardPos();
-		if (onlysel && cur.pit() == endcur.pit() && cur.idx() == endcur.idx()) {
+			par.eraseChars(pos, pos + rit->second,
+				       buf.params().track_changes);
+		par.insert(pos, replacestr, font,
+			   Change(buf.params().track_changes
+				  ? Change::INSERTED
+				  : Change::UNCHANGED));
+		if (onlysel && cur.pit() == endcur.pit() && cur.idx() == endcur.idx())
 			// Adjust end of selection for replace-all in selection
-			if (rsize > ssize) {
-				int const offset = rsize - ssize;
-				for (int i = 0; i < offset + ct_deleted_text
-				     && endcur.pos() < endcur.lastpos(); ++i)
-					endcur.forwardPos();
-			} else {
-				int const offset = ssize - rsize;
-				for (int i = 0; i < offset && endcur.pos() > 0; ++i)
-					endcur.backwardPos();
-				for (int i = 0; i < ct_deleted_text
-				     && endcur.pos() < endcur.lastpos(); ++i)
-					endcur.forwardPos();
-			}
-		}
-		++num;
-		match_len = findForward(cur, endcur, match, false, onlysel);
+			endcur_shift += rsize - ssize + ct_deleted_text;
 	}
+	if (endcur_shift != 0)
+		endcur.pos() = max(pos_type(0),
+				   min(endcur.pos() + endcur_shift, endcur.lastpos()));
+	int const num = cancelled ? -1 : int(matches.size());
 
 	bv->putSelectionAt(doc_iterator_begin(&buf), 0, false);
 
@@ -658,6 +686,9 @@ bool lyxreplace(BufferView * bv, FuncRequest const & ev)
 	if (all) {
 		replace_count = replaceAll(bv, search, rplc, casesensitive,
 					   matchword, onlysel);
+		// replaceAll() has told about a cancellation already
+		if (replace_count < 0)
+			return false;
 		update = replace_count > 0;
 	} else {
 		pair<bool, int> rv =
@@ -1075,6 +1106,17 @@ public:
 	};
 	string matchTypeAsString(matchType const x) const { return (x == MatchFromStart ? "MatchFromStart" : "MatchAnyPlace"); }
 	MatchResult operator()(DocIterator const & cur, int len, matchType at_begin) const;
+	/** Cheap pre-filter for the paragraph of \p cur.
+	 **
+	 ** @return
+	 ** False if the paragraph cannot contain a match, because it lacks
+	 ** the literal text that every match must contain. True otherwise,
+	 ** in which case operator() has to be used to find out.
+	 **/
+	bool mayMatch(DocIterator const & cur) const;
+	/// Forget what mayMatch() found out, to be called when the
+	/// buffer has been changed.
+	void clearLiteralCache() const { literal_cache.clear(); }
 #if QTSEARCH
 	bool regexIsValid;
 	string regexError;
@@ -1127,6 +1169,10 @@ private:
 	// number of (.*?) subexpressions added at end of search regexp for closing
 	// environments, math mode, styles, etc...
 	int close_wildcards;
+	// literal text every match has to contain, empty if unknown
+	docstring required_literal;
+	// whether a paragraph contains required_literal, filled by mayMatch()
+	mutable unordered_map<Paragraph const *, bool> literal_cache;
 public:
 	// Are we searching with regular expressions ?
 	bool use_regexp = false;
@@ -1270,6 +1316,44 @@ static docstring stringifySearchBuffer(Buffer & buffer, FindAndReplaceOptions co
 }
 
 
+/// Options used to get the plain text of a paragraph for literal matching
+static int literalStringOptions()
+{
+	return ignoreFormats.getDeleted() ? AS_STR_SKIPDELETE : AS_STR_NONE;
+}
+
+
+/** Returns the longest run of ASCII letters and digits that every match
+ * of the (non regexp) search buffer has to contain, in lowercase unless
+ * the search is case sensitive. The run is only determined for a single
+ * paragraph without insets and without backslashes, because otherwise
+ * the text may be stringified differently in the document.
+ */
+static docstring requiredLiteral(Buffer const & buffer, FindAndReplaceOptions const & opt)
+{
+	ParagraphList const & pars = buffer.paragraphs();
+	if (pars.size() != 1 || !pars.front().insetList().empty())
+		return docstring();
+	docstring const text = pars.front().asString(literalStringOptions());
+	if (text.find('\\') != docstring::npos)
+		return docstring();
+	size_t best_start = 0;
+	size_t best_len = 0;
+	size_t start = 0;
+	for (size_t i = 0; i <= text.size(); ++i) {
+		if (i < text.size() && isAlnumASCII(text[i]))
+			continue;
+		if (i - start > best_len) {
+			best_start = start;
+			best_len = i - start;
+		}
+		start = i + 1;
+	}
+	docstring const literal = text.substr(best_start, best_len);
+	return opt.casesensitive ? literal : ascii_lowercase(literal);
+}
+
+
 /// Return separation pos between the leading material and the rest
 static size_t identifyLeading(string const & s)
 {
@@ -3677,6 +3761,8 @@ MatchStringAdv::MatchStringAdv(lyx::Buffer & buf, FindAndReplaceOptions & opt)
 	}
 	opt.matchAtStart = false;
 	if (!use_regexp) {
+		required_literal = requiredLiteral(find_buf, opt);
+		LYXERR(Debug::FINDVERBOSE, "Required literal: '" << required_literal << "'");
 		identifyClosing(par_as_string, opt.ignoreformat); // Removes math closings ($, ], ...) at end of string
 		if (opt.ignoreformat) {
 			lead_size = 0;
@@ -3958,6 +4044,27 @@ MatchResult MatchStringAdv::operator()(DocIterator const & cur, int len, MatchSt
 	return mres;
 }
 
+bool MatchStringAdv::mayMatch(DocIterator const & cur) const
+{
+	if (required_literal.empty() || !cur.inTexted())
+		return true;
+	Paragraph const & par = cur.paragraph();
+	// Inset contents are not part of the paragraph text
+	if (!par.insetList().empty())
+		return true;
+	unordered_map<Paragraph const *, bool>::const_iterator it =
+		literal_cache.find(&par);
+	if (it != literal_cache.end())
+		return it->second;
+	docstring text = par.asString(literalStringOptions());
+	if (!opt.casesensitive)
+		text = ascii_lowercase(text);
+	bool const found = text.find(required_literal) != docstring::npos;
+	literal_cache[&par] = found;
+	return found;
+}
+
+
 #if 0
 static bool simple_replace(string &t, string from, string to)
 {
@@ -4378,6 +4485,12 @@ int findForwardAdv(DocIterator & cur, MatchStringAdv & match)
 	while (!theApp()->longOperationCancelled() && cur) {
 		//(void) findAdvForwardInnermost(cur);
 		LYXERR(Debug::FINDVERBOSE, "findForwardAdv() cur: " << cur);
+		if (repeat == 0 && !match.mayMatch(cur)) {
+			// Skip the paragraph without stringifying it
+			cur.pos() = cur.lastpos();
+			cur.forwardPos();
+			continue;
+		}
 		MatchResult mres = match(cur, -1, MatchStringAdv::MatchAnyPlace);
 		string msg = "Starting";
 		if (repeat > 0)
@@ -4524,7 +4637,9 @@ int findBackwardsAdv(DocIterator & cur, MatchStringAdv & match)
 	bool pit_changed = false;
 	do {
 		cur.pos() = 0;
-		MatchResult found_match = match(cur, -1, MatchStringAdv::MatchAnyPlace);
+		MatchResult found_match;
+		if (match.mayMatch(cur))
+			found_match = match(cur, -1, MatchStringAdv::MatchAnyPlace);
 
 		if (found_match.match_len > 0) {
 			if (pit_changed)
@@ -4675,7 +4790,12 @@ static bool replaceMatches(string &t, int maxmatchnum, vector <string> const & r
 }
 
 ///
-static int findAdvReplace(BufferView * bv, FindAndReplaceOptions const & opt, MatchStringAdv & matchAdv)
+/** Replaces the current selection if it is a match.
+ * If \p bulk is true, the full buffer and screen updates are left to
+ * the caller, which is expected to do them once for all replacements.
+ */
+static int findAdvReplace(BufferView * bv, FindAndReplaceOptions const & opt,
+			  MatchStringAdv & matchAdv, bool bulk = false)
 {
 	Cursor & cur = bv->cursor();
 	if (opt.repl_buf_name.empty()
@@ -4719,7 +4839,27 @@ static int findAdvReplace(BufferView * bv, FindAndReplaceOptions const & opt, Ma
 				changeFirstCase(repl_buffer, text_uppercase, text_uppercase);
 		}
 	}
-	cap::cutSelection(cur, false);
+	bool has_insets = false;
+	if (bulk && cur.inTexted())
+		for (pos_type pos = sel_beg.pos(); pos < sel_end.pos(); ++pos)
+			if (cur.paragraph().isInset(pos)) {
+				has_insets = true;
+				break;
+			}
+	if (bulk && cur.inTexted() && !has_insets) {
+		// The selection lies within a single paragraph, so erase it
+		// directly. cap::cutSelection() would update the whole buffer
+		// for each single replacement. This is only safe without
+		// insets, since erased labels and references would stay in
+		// the buffer caches until the next update.
+		cap::saveSelection(cur);
+		cur.recordUndo();
+		BufferParams const & bp = cur.buffer()->params();
+		cur.pos() = sel_end.pos() - cur.paragraph().eraseChars(
+			sel_beg.pos(), sel_end.pos(), bp.track_changes);
+		cur.clearSelection();
+	} else
+		cap::cutSelection(cur, false);
 	if (cur.inTexted()) {
 		repl_buffer.changeLanguage(
 					repl_buffer.language(),
@@ -4754,13 +4894,16 @@ static int findAdvReplace(BufferView * bv, FindAndReplaceOptions const & opt, Ma
 		sel_len = ar.size();
 		LYXERR(Debug::FINDVERBOSE, "After insert() cur=" << cur << " with depth: " << cur.depth() << " and len: " << sel_len);
 	}
+	// Paragraphs may have been changed, merged or deleted
+	matchAdv.clearLiteralCache();
 	if (cur.pos() >= sel_len)
 		cur.pos() -= sel_len;
 	else
 		cur.pos() = 0;
 	LYXERR(Debug::FINDVERBOSE, "After pos adj cur=" << cur << " with depth: " << cur.depth() << " and len: " << sel_len);
 	bv->putSelectionAt(DocIterator(cur), sel_len, !opt.forward);
-	bv->processUpdateFlags(Update::Force);
+	if (!bulk)
+		bv->processUpdateFlags(Update::Force);
 	return 1;
 }
 
@@ -4841,6 +4984,32 @@ bool findAdv(BufferView * bv, FindAndReplaceOptions & opt)
 		}
 		else
 			pos_len = findBackwardsAdv(cur, matchAdv);
+
+		// When replacing all, go on with the remaining matches right
+		// here, and update the buffer and the screen only once.
+		int bulk_replaced = 0;
+		while (opt.replace_all && pos_len > 0) {
+			if (theApp()->longOperationCancelled()) {
+				pos_len = 0;
+				break;
+			}
+			if (cur.pos() + pos_len > cur.lastpos())
+				pos_len = cur.lastpos() - cur.pos();
+			bv->putSelectionAt(cur, pos_len, !opt.forward);
+			if (findAdvReplace(bv, opt, matchAdv, true) == 0)
+				break;
+			if (++bulk_replaced % 100 == 0)
+				bv->message(bformat(_("%1$d matches have been replaced."),
+						    num_replaced + bulk_replaced));
+			cur = bv->cursor();
+			pos_len = opt.forward ? findForwardAdv(cur, matchAdv)
+					      : findBackwardsAdv(cur, matchAdv);
+		}
+		if (bulk_replaced > 0) {
+			num_replaced += bulk_replaced;
+			bv->buffer().updateBuffer();
+			bv->processUpdateFlags(Update::Force);
+		}
 	} catch (exception & ex) {
 		bv->message(from_utf8(ex.what()));
 		return false;
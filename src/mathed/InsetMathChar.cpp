@@ -26,10 +26,15 @@
 #include "frontends/FontMetrics.h"
 
 #include "support/debug.h"
+#include "support/lassert.h"
 #include "support/lstrings.h"
+#include "support/mutex.h"
 #include "support/textutils.h"
 
 #include <algorithm>
+#include <functional>
+#include <new>
+#include <vector>
 
 using namespace std;
 
@@ -84,6 +89,104 @@ latexkeys const * makeSubstitute(char_type c)
 	return in_word_set(from_ascii(name));
 }
 
+
+/// A pool of memory blocks for InsetMathChar objects. The blocks are
+/// allocated in chunks, and a chunk is given back to the system as
+/// soon as all its blocks are free again, except for the chunk that
+/// is currently allocated from.
+class CharPool {
+public:
+	///
+	CharPool() : current_(nullptr) {}
+	///
+	void * allocate()
+	{
+		Mutex::Locker lock(&mutex_);
+		if (!current_ || !current_->free) {
+			current_ = nullptr;
+			for (Chunk * chunk : chunks_)
+				if (chunk->free) {
+					current_ = chunk;
+					break;
+				}
+			if (!current_) {
+				current_ = new Chunk;
+				chunks_.insert(upper_bound(chunks_.begin(), chunks_.end(),
+				                           current_, less<Chunk const *>()),
+				               current_);
+			}
+		}
+		Block * const block = current_->free;
+		current_->free = block->next;
+		++current_->used;
+		return block;
+	}
+	///
+	void deallocate(void * p)
+	{
+		Mutex::Locker lock(&mutex_);
+		Block * const block = static_cast<Block *>(p);
+		// The chunk of the block is the last one that starts before it
+		vector<Chunk *>::iterator it =
+			upper_bound(chunks_.begin(), chunks_.end(), block,
+			            [](Block const * b, Chunk const * c) {
+				return less<void const *>()(b, c);
+			});
+		LASSERT(it != chunks_.begin(), return);
+		Chunk * const chunk = *--it;
+		block->next = chunk->free;
+		chunk->free = block;
+		if (--chunk->used == 0 && chunk != current_) {
+			chunks_.erase(it);
+			delete chunk;
+		}
+	}
+
+private:
+	///
+	union Block {
+		Block * next;
+		alignas(InsetMathChar) unsigned char data[sizeof(InsetMathChar)];
+	};
+	///
+	static size_t const chunk_size = 1024;
+	///
+	struct Chunk {
+		///
+		Chunk() : free(nullptr), used(0)
+		{
+			for (size_t i = 0; i != chunk_size; ++i) {
+				blocks[i].next = free;
+				free = &blocks[i];
+			}
+		}
+		/// This must come first, see deallocate()
+		Block blocks[chunk_size];
+		/// The free blocks of this chunk
+		Block * free;
+		/// The number of blocks in use
+		size_t used;
+	};
+	/// The chunk that blocks are allocated from
+	Chunk * current_;
+	/// All chunks, sorted by address
+	vector<Chunk *> chunks_;
+	/// Char insets are created and destroyed by export and preview
+	/// threads too, and a block may be freed by another thread than
+	/// the one that allocated it. A per-thread pool would lose the
+	/// blocks on its free list when its thread ends.
+	Mutex mutex_;
+};
+
+
+CharPool & charPool()
+{
+	// This is never destroyed, since char insets may still be
+	// destroyed by other static destructors.
+	static CharPool * pool = new CharPool;
+	return *pool;
+}
+
 } //anonymous namespace
 
 
@@ -99,6 +202,25 @@ InsetMathChar::InsetMathChar(char_type c)
 
 
 
+void * InsetMathChar::operator new(size_t size)
+{
+	if (size != sizeof(InsetMathChar))
+		return ::operator new(size);
+	return charPool().allocate();
+}
+
+
+void InsetMathChar::operator delete(void * p, size_t size)
+{
+	if (!p)
+		return;
+	if (size != sizeof(InsetMathChar))
+		::operator delete(p);
+	else
+		charPool().deallocate(p);
+}
+
+
 Inset * InsetMathChar::clone() const
 {
 	return new InsetMathChar(*this);
@@ -14,6 +14,8 @@
 
 #include "InsetMath.h"
 
+#include <cstddef>
+
 namespace lyx {
 
 class latexkeys;
@@ -23,6 +25,12 @@ class InsetMathChar : public InsetMath {
 public:
 	///
 	explicit InsetMathChar(char_type c);
+	/// Character insets are by far the most frequent math insets. They
+	/// are allocated from a pool, which avoids the overhead of the
+	/// general purpose allocator in memory and time.
+	static void * operator new(std::size_t size);
+	///
+	static void operator delete(void * p, std::size_t size);
 	///
 	void metrics(MetricsInfo & mi, Dimension & dim) const override;
 	///
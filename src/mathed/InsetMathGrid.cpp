@@ -595,16 +595,24 @@ int InsetMathGrid::hLineVOffset(BufferView const & bv, row_type row,
 void InsetMathGrid::draw(PainterInfo & pi, int x, int y) const
 {
 	BufferView const & bv = *pi.base.bv;
+	// The positions of the cells have been set in the nodraw stage,
+	// which draws everything. On screen, it is enough to draw the rows
+	// that are visible, which matters for long grids.
+	bool const on_screen = !pi.pain.isNull();
+	int const wh = bv.workHeight();
 
 	for (idx_type idx = 0; idx < nargs(); ++idx) {
 		if (cellinfo_[idx].multi != CELL_PART_OF_MULTICOLUMN) {
+			row_type r = row(idx);
+			int const yy1 = y + hLineVOffset(bv, r, 0);
+			int const yy2 = y + hLineVOffset(bv, r + 1, rowinfo_[r + 1].lines - 1);
+			if (on_screen && (yy2 < 0 || yy1 >= wh))
+				continue;
+
 			cell(idx).draw(pi,
 			               x + leftMargin() + cellXOffset(bv, idx),
 			               y + cellYOffset(bv, idx));
 
-			row_type r = row(idx);
-			int const yy1 = y + hLineVOffset(bv, r, 0);
-			int const yy2 = y + hLineVOffset(bv, r + 1, rowinfo_[r + 1].lines - 1);
 			auto draw_left_borders = [&](col_type c) {
 				for (unsigned int i = 0; i < colinfo_[c].lines; ++i) {
 					int const xx = x + vLineHOffset(c, i);
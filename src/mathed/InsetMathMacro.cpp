@@ -209,7 +209,9 @@ public:
 		  expanded_(buf), definition_(buf), attachedArgsNum_(0),
 		  optionals_(0), nextFoldMode_(true), macroBackup_(buf),
 		  macro_(nullptr), needsUpdate_(false), isUpdating_(false),
-		  appetite_(9), nesting_(0), limits_(AUTO_LIMITS)
+		  appetite_(9), nesting_(0), limits_(AUTO_LIMITS),
+		  update_epoch_(0), output_updated_(false),
+		  updated_mode_(DISPLAY_INIT)
 	{
 	}
 	/// Update the pointers to our owner of all expanded macros.
@@ -253,6 +255,14 @@ public:
 	int nesting_;
 	///
 	Limits limits_;
+	/// the last call of Buffer::updateMacroInstances that updated us
+	unsigned int update_epoch_;
+	/// was that an OutputUpdate?
+	bool output_updated_;
+	/// the name at that time
+	docstring updated_name_;
+	/// the display mode at that time
+	DisplayMode updated_mode_;
 };
 
 
@@ -310,6 +320,8 @@ InsetMathMacro::InsetMathMacro(Buffer * buf, docstring const & name)
 InsetMathMacro::InsetMathMacro(InsetMathMacro const & that)
 	: InsetMathNest(that), d(new Private(*that.d))
 {
+	// The copy may be in a different context
+	d->update_epoch_ = 0;
 	// FIXME This should not really be necessary, but when we are
 	// initializing the table of global macros, we create macros
 	// with no associated Buffer.
@@ -325,6 +337,7 @@ InsetMathMacro & InsetMathMacro::operator=(InsetMathMacro const & that)
 		return *this;
 	InsetMathNest::operator=(that);
 	*d = *that.d;
+	d->update_epoch_ = 0;
 	d->updateChildren(this);
 	return *this;
 }
@@ -744,6 +757,28 @@ void InsetMathMacro::updateRepresentation(Cursor * cur, MacroContext const & mc,
 }
 
 
+void InsetMathMacro::setUpdated(unsigned int epoch, UpdateType utype)
+{
+	d->update_epoch_ = epoch;
+	d->output_updated_ = utype == OutputUpdate;
+	d->updated_name_ = name();
+	d->updated_mode_ = d->displayMode_;
+}
+
+
+bool InsetMathMacro::isUpdated(unsigned int epoch, UpdateType utype,
+		MacroNameSet const & changed) const
+{
+	// An OutputUpdate also updates the macros in the expansion.
+	// Changed arguments set needsUpdate_ without changing the name.
+	return epoch != 0 && d->update_epoch_ == epoch && !d->needsUpdate_
+		&& (utype == InternalUpdate || d->output_updated_)
+		&& d->displayMode_ == d->updated_mode_
+		&& d->updated_name_ == name()
+		&& changed.find(d->updated_name_) == changed.end();
+}
+
+
 void InsetMathMacro::draw(PainterInfo & pi, int x, int y) const
 {
 	Dimension const dim = dimension(*pi.base.bv);
@@ -176,6 +176,14 @@ protected:
 	/// check if macro definition changed, argument changed etc. and adapt
 	void updateRepresentation(Cursor * cur, MacroContext const & mc,
 	                          UpdateType, int nesting);
+	/// remember that the macro has been updated in the call \p epoch
+	/// of Buffer::updateMacroInstances
+	void setUpdated(unsigned int epoch, UpdateType);
+	/// Has the macro been updated in the call \p epoch of
+	/// Buffer::updateMacroInstances, and is this still valid although
+	/// the macros \p changed have been redefined since?
+	bool isUpdated(unsigned int epoch, UpdateType,
+	               MacroNameSet const & changed) const;
 	/// empty macro, put arguments into args, possibly strip arity-attachedArgsNum_ empty ones.
 	/// Includes the optional arguments.
 	void detachArguments(std::vector<MathData> & args, bool strip);
@@ -21,6 +21,7 @@
 #include "InsetMathNest.h"
 
 #include "Buffer.h"
+#include "BufferParams.h"
 #include "InsetList.h"
 #include "Text.h"
 
@@ -28,6 +29,7 @@
 #include "support/gettext.h"
 #include "support/lassert.h"
 
+#include <atomic>
 #include <sstream>
 
 using namespace std;
@@ -41,6 +43,54 @@ namespace lyx {
 //
 /////////////////////////////////////////////////////////////////////
 
+namespace {
+
+/// Incremented whenever the macros of some buffer may have changed
+atomic<unsigned int> macro_generation(0);
+
+} // namespace
+
+
+/// A parsed macro definition, and what the parse depends on
+class MacroData::ParsedDefinition {
+public:
+	///
+	ParsedDefinition(Buffer const * buf, docstring const & def)
+		: definition(def), generation(macro_generation),
+		  mhchem(mhchemSetting(buf)),
+		  encoding(buf ? &buf->params().encoding() : nullptr),
+		  data(const_cast<Buffer *>(buf))
+	{
+		asArray(definition, data, Parse::QUIET | Parse::MACRODEF);
+	}
+	/// Would parsing \p def for \p buf give the same result?
+	bool valid(Buffer const * buf, docstring const & def) const
+	{
+		return generation == macro_generation
+			&& definition == def
+			&& mhchem == mhchemSetting(buf)
+			&& encoding == (buf ? &buf->params().encoding() : nullptr);
+	}
+	///
+	docstring const definition;
+	/// The macros known when parsing
+	unsigned int const generation;
+	/// Whether \ce and \cf are macros, see Parser::parse1()
+	int const mhchem;
+	/// Which characters are read as such, see Parser::parse1()
+	Encoding const * const encoding;
+	///
+	MathData data;
+
+private:
+	///
+	static int mhchemSetting(Buffer const * buf)
+	{
+		return buf ? buf->params().use_package("mhchem") : -1;
+	}
+};
+
+
 MacroData::MacroData(const Buffer * buf)
 	: buffer_(buf), queried_(true)
 {}
@@ -66,7 +116,17 @@ bool MacroData::expand(vector<MathData> const & from, MathData & to) const
 	InsetMathSqrt inset(const_cast<Buffer *>(buffer_));
 
 	docstring const & definition(display_.empty() ? definition_ : display_);
-	asArray(definition, inset.cell(0), Parse::QUIET | Parse::MACRODEF);
+	// Every instance of the macro is expanded, and copying the parsed
+	// definition is much cheaper than parsing it again.
+	shared_ptr<ParsedDefinition const> parsed = parsed_;
+	if (!parsed || !parsed->valid(buffer_, definition)) {
+		parsed = make_shared<ParsedDefinition>(buffer_, definition);
+		// Do not modify the global macros, which are shared by
+		// all threads
+		if (buffer_)
+			parsed_ = parsed;
+	}
+	inset.cell(0) = parsed->data;
 	//lyxerr << "MathData::expand: args: " << args << endl;
 	//LYXERR0("MathData::expand: ar: " << inset.cell(0));
 	for (DocIterator it = doc_iterator_begin(buffer_, &inset); it; it.forwardChar()) {
@@ -83,7 +143,8 @@ bool MacroData::expand(vector<MathData> const & from, MathData & to) const
 		}
 	}
 	//LYXERR0("MathData::expand: res: " << inset.cell(0));
-	to = inset.cell(0);
+	// The cell is thrown away, no need to copy it
+	to.swap(inset.cell(0));
 	// If the result is equal to the definition then we either have a
 	// recursive loop, or the definition did not contain any macro in the
 	// first place.
@@ -91,6 +152,12 @@ bool MacroData::expand(vector<MathData> const & from, MathData & to) const
 }
 
 
+void MacroData::macrosChanged()
+{
+	++macro_generation;
+}
+
+
 size_t MacroData::optionals() const
 {
 	updateData();
@@ -18,6 +18,7 @@
 #include "support/docstring.h"
 
 #include <map>
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -72,6 +73,8 @@ public:
 	void setSymbol(latexkeys const * sym) { sym_ = sym; }
 	///
 	DocIterator const & pos() const { return pos_; }
+	/// Has the data already been read from the macro template?
+	bool queried() const { return queried_; }
 
 	/// lock while being drawn to avoid recursions
 	int lock() const { return ++lockCount_; }
@@ -89,6 +92,11 @@ public:
 	/// output as TeX macro, only works for lazy MacroData!!!
 	int write(odocstream & os, bool overwriteRedefinition) const;
 
+	/// To be called when the macros of a buffer may have changed.
+	/// The parsed definitions kept by expand() are then out of date,
+	/// since parsing depends on the known macros.
+	static void macrosChanged();
+
 	///
 	bool operator==(MacroData const & x) const {
 		updateData();
@@ -139,6 +147,13 @@ private:
 	mutable bool redefinition_ = false;
 	///
 	mutable MacroType type_ = MacroTypeNewcommand;
+	///
+	class ParsedDefinition;
+	/// The parsed definition used by expand(), shared by the copies
+	/// of this object since it is never modified. It is only kept
+	/// for macros of a buffer: the global macros are used by all
+	/// threads.
+	mutable std::shared_ptr<ParsedDefinition const> parsed_;
 };
 
 
@@ -306,8 +306,8 @@ void MathData::metrics(MetricsInfo & mi, Dimension & dim, bool tight) const
 		if (e.type == MathRow::BEGIN && e.ar)
 			bv->setMathRow(e.ar, caret_row);
 
-	// Cache row and dimension.
-	bv->setMathRow(this, mrow);
+	// Cache row and dimension. The row is not used here anymore.
+	bv->setMathRow(this, move(mrow));
 	bv->coordCache().arrays().add(this, dim);
 }
 
@@ -400,7 +400,8 @@ void MathData::updateBuffer(ParIterator const & it, UpdateType utype, bool const
 
 
 void MathData::updateMacros(Cursor * cur, MacroContext const & mc,
-		UpdateType utype, int nesting)
+		UpdateType utype, int nesting, unsigned int epoch,
+		MacroNameSet const * changed)
 {
 	// If we are editing a macro, we cannot update it immediately,
 	// otherwise wrong undo steps will be recorded (bug 6208).
@@ -419,6 +420,12 @@ void MathData::updateMacros(Cursor * cur, MacroContext const & mc,
 						InsetMathMacro::DISPLAY_UNFOLDED))
 			continue;
 
+		// nothing changed since the last update?
+		if (changed && macroInset->isUpdated(epoch - 1, utype, *changed)) {
+			macroInset->setUpdated(epoch, utype);
+			continue;
+		}
+
 		// get macro
 		macroInset->updateMacro(mc);
 		size_t macroNumArgs = 0;
@@ -490,6 +497,8 @@ void MathData::updateMacros(Cursor * cur, MacroContext const & mc,
 			inset = inset->asScriptInset()->nuc()[0].nucleus();
 		LASSERT(inset->asMacro(), continue);
 		inset->asMacro()->updateRepresentation(cur, mc, utype, nesting + 1);
+		if (epoch)
+			inset->asMacro()->setUpdated(epoch, utype);
 	}
 }
 
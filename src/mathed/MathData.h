@@ -37,6 +37,7 @@ class DocIterator;
 class InsetMathMacro;
 class LaTeXFeatures;
 class MacroContext;
+class MacroNameSet;
 class MathRow;
 class MetricsInfo;
 class PainterInfo;
@@ -184,7 +185,13 @@ public:
 
 	/// attach/detach arguments to macros, updating the cur to
 	/// stay visually at the same position (cur==0 is allowed)
-	void updateMacros(Cursor * cur, MacroContext const & mc, UpdateType, int nesting);
+	/// \p epoch numbers the calls of Buffer::updateMacroInstances, if
+	/// this is called from there. If \p changed is given, the macros
+	/// that are up to date after the previous call and whose names are
+	/// not in \p changed are left alone.
+	void updateMacros(Cursor * cur, MacroContext const & mc, UpdateType,
+	                  int nesting, unsigned int epoch = 0,
+	                  MacroNameSet const * changed = nullptr);
 	///
 	void updateBuffer(ParIterator const &, UpdateType, bool const deleted = false);
 	///
@@ -75,6 +75,7 @@
 #include "LyX.h" // use_gui
 
 #include <iomanip>
+#include <unordered_map>
 
 using namespace std;
 using namespace lyx::support;
@@ -88,6 +89,12 @@ namespace {
 
 MathWordList theMathWordList;
 
+/// The entries of theMathWordList that in_word_set() returns. The parser
+/// looks up every command, hence the hashing.
+typedef std::unordered_map<docstring, latexkeys const *, docstring_hash>
+	MathWordIndex;
+MathWordIndex theMathWordIndex;
+
 
 bool isMathFontAvailable(string & name)
 {
@@ -326,8 +333,11 @@ void initSymbols()
 		if (theMathWordList.find(tmp.name) != theMathWordList.end())
 			LYXERR(Debug::MATHED, "readSymbols: inset " << to_utf8(tmp.name)
 				<< " already exists.");
-		else
-			theMathWordList[tmp.name] = tmp;
+		else {
+			latexkeys const & word = theMathWordList[tmp.name] = tmp;
+			if (word.inset != "macro")
+				theMathWordIndex[word.name] = &word;
+		}
 
 		// If you change the following output, please adjust
 		// development/tools/generate_symbols_images.py.
@@ -438,12 +448,8 @@ int ensureMode(TeXMathStream & os, InsetMath::mode_type mode,
 
 latexkeys const * in_word_set(docstring const & str)
 {
-	MathWordList::iterator it = theMathWordList.find(str);
-	if (it == theMathWordList.end())
-		return nullptr;
-	if (it->second.inset == "macro")
-		return nullptr;
-	return &(it->second);
+	MathWordIndex::const_iterator it = theMathWordIndex.find(str);
+	return it == theMathWordIndex.end() ? nullptr : it->second;
 }
 
 
@@ -428,8 +428,6 @@ private:
 	///
 	void tokenize(docstring const & s);
 	///
-	void skipSpaceTokens(idocstream & is, char_type c);
-	///
 	void push_back(Token const & t);
 	///
 	Token const & prevToken() const;
@@ -586,27 +584,19 @@ docstring Parser::getArg(char_type left, char_type right)
 }
 
 
-void Parser::skipSpaceTokens(idocstream & is, char_type c)
-{
-	// skip trailing spaces
-	while (catcode(c) == catSpace || catcode(c) == catNewline)
-		if (!is.get(c))
-			break;
-	//lyxerr << "putting back: " << c << endl;
-	is.putback(c);
-}
-
-
 void Parser::tokenize(istream & is)
 {
 	// eat everything up to the next \end_inset or end of stream
 	// and store it in s for further tokenization
+	static string const end_inset = "\\end_inset";
 	string s;
 	char c;
 	while (is.get(c)) {
 		s += c;
-		if (s.size() >= 10 && s.substr(s.size() - 10) == "\\end_inset") {
-			s = s.substr(0, s.size() - 10);
+		if (c == 't' && s.size() >= end_inset.size()
+		    && s.compare(s.size() - end_inset.size(), end_inset.size(),
+		                 end_inset) == 0) {
+			s.resize(s.size() - end_inset.size());
 			break;
 		}
 	}
@@ -621,30 +611,42 @@ void Parser::tokenize(istream & is)
 
 void Parser::tokenize(docstring const & buffer)
 {
-	idocstringstream is((mode_ & Parse::VERBATIM)
-			? escapeSpecialChars(buffer, mode_ & Parse::TEXTMODE)
-			: buffer, ios::in | ios::binary);
-
-	char_type c;
-	while (is.get(c)) {
+	docstring escaped;
+	if (mode_ & Parse::VERBATIM)
+		escaped = escapeSpecialChars(buffer, mode_ & Parse::TEXTMODE);
+	docstring const & is = (mode_ & Parse::VERBATIM) ? escaped : buffer;
+	size_t const n = is.size();
+	// There is at most one token per character
+	tokens_.reserve(tokens_.size() + n);
+
+	// skip trailing spaces starting at \p i
+	auto skipSpaceChars = [&is, n](size_t i) {
+		while (i < n && (catcode(is[i]) == catSpace
+		                 || catcode(is[i]) == catNewline))
+			++i;
+		return i;
+	};
+
+	size_t i = 0;
+	while (i < n) {
+		char_type c = is[i++];
 		//lyxerr << "reading c: " << c << endl;
 
 		switch (catcode(c)) {
 			case catNewline: {
 				++lineno_;
-				is.get(c);
-				if (catcode(c) == catNewline)
-					; //push_back(Token("par"));
-				else {
+				if (i == n)
+					break;
+				if (catcode(is[i]) == catNewline)
+					++i; //push_back(Token("par"));
+				else
 					push_back(Token('\n', catNewline));
-					is.putback(c);
-				}
 				break;
 			}
 
 /*
 			case catComment: {
-				while (is.get(c) && catcode(c) != catNewline)
+				while (i < n && catcode(is[i++]) != catNewline)
 					;
 				++lineno_;
 				break;
@@ -652,20 +654,21 @@ void Parser::tokenize(docstring const & buffer)
 */
 
 			case catEscape: {
-				is.get(c);
-				if (!is) {
+				if (i == n) {
 					error("unexpected end of input");
 				} else {
+					c = is[i++];
 					if (c == '\n')
 						c = ' ';
-					docstring s(1, c);
 					if (catcode(c) == catLetter) {
 						// collect letters
-						while (is.get(c) && catcode(c) == catLetter)
-							s += c;
-						skipSpaceTokens(is, c);
-					}
-					push_back(Token(s));
+						size_t const first = i - 1;
+						while (i < n && catcode(is[i]) == catLetter)
+							++i;
+						push_back(Token(is.substr(first, i - first)));
+						i = skipSpaceChars(i);
+					} else
+						push_back(Token(docstring(1, c)));
 				}
 				break;
 			}
@@ -673,8 +676,7 @@ void Parser::tokenize(docstring const & buffer)
 			case catSuper:
 			case catSub: {
 				push_back(Token(c, catcode(c)));
-				is.get(c);
-				skipSpaceTokens(is, c);
+				i = skipSpaceChars(i);
 				break;
 			}
 
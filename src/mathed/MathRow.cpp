@@ -149,6 +149,9 @@ void drawMarkers(PainterInfo const & pi, MathRow::Element const & e,
 
 MathRow::MathRow(MetricsInfo & mi, MathData const * ar)
 {
+	// Usually, there is one element per atom, plus the ones below
+	elements_.reserve(ar->size() + 3);
+
 	// First there is a dummy element of type "open"
 	push_back(Element(mi, DUMMY, MC_OPEN));
 
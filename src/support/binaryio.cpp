@@ -0,0 +1,129 @@
+/**
+ * \file binaryio.cpp
+ * This file is part of LyX, the document processor.
+ * Licence details can be found in the file COPYING.
+ *
+ * Full author contact details are available in file CREDITS.
+ */
+
+#include <config.h>
+
+#include "support/binaryio.h"
+
+#include "support/debug.h"
+#include "support/FileName.h"
+#include "support/TempFile.h"
+#include "support/unique_ptr.h"
+
+#include <algorithm>
+#include <fstream>
+
+using namespace std;
+
+namespace lyx {
+
+namespace support {
+
+void writeNumber(ostream & os, uint64_t n)
+{
+	os.write(reinterpret_cast<char const *>(&n), sizeof(n));
+}
+
+
+bool readNumber(istream & is, uint64_t & n)
+{
+	return bool(is.read(reinterpret_cast<char *>(&n), sizeof(n)));
+}
+
+
+void writeString(ostream & os, string const & s)
+{
+	writeNumber(os, s.size());
+	os.write(s.data(), s.size());
+}
+
+
+bool readString(istream & is, string & s)
+{
+	uint64_t size;
+	if (!readNumber(is, size))
+		return false;
+	// The size may be garbage, so read in pieces instead of
+	// allocating all memory up front
+	uint64_t const piece = 65536;
+	s.clear();
+	while (size > 0) {
+		size_t const len = size_t(min(size, piece));
+		size_t const old_size = s.size();
+		s.resize(old_size + len);
+		if (!is.read(&s[old_size], len))
+			return false;
+		size -= len;
+	}
+	return true;
+}
+
+
+void writeString(ostream & os, docstring const & s)
+{
+	writeString(os, to_utf8(s));
+}
+
+
+bool readString(istream & is, docstring & s)
+{
+	string utf8;
+	if (!readString(is, utf8))
+		return false;
+	s = from_utf8(utf8);
+	return true;
+}
+
+
+void writeStrings(ostream & os, vector<docstring> const & v)
+{
+	writeNumber(os, v.size());
+	for (docstring const & s : v)
+		writeString(os, s);
+}
+
+
+bool readStrings(istream & is, vector<docstring> & v)
+{
+	uint64_t size;
+	if (!readNumber(is, size))
+		return false;
+	v.clear();
+	docstring s;
+	for (uint64_t i = 0; i < size; ++i) {
+		if (!readString(is, s))
+			return false;
+		v.push_back(s);
+	}
+	return true;
+}
+
+
+bool replaceFile(FileName const & file, string const & contents)
+{
+	auto tempfile = lyx::make_unique<TempFile>(file.onlyPath(),
+		file.onlyFileName() + "-XXXXXX");
+	tempfile->setAutoRemove(false);
+	FileName const tmp = tempfile->name();
+	if (tmp.empty())
+		return false;
+	ofstream os(tmp.toFilesystemEncoding().c_str(), ios::binary | ios::trunc);
+	os.write(contents.data(), contents.size());
+	os.close();
+	// The temp file keeps the file locked on Windows
+	tempfile.reset();
+	if (!os || !tmp.moveTo(file)) {
+		LYXERR(Debug::FILES, "Could not write " << file);
+		tmp.removeFile();
+		return false;
+	}
+	return true;
+}
+
+} // namespace support
+} // namespace lyx
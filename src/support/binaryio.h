@@ -0,0 +1,57 @@
+// -*- C++ -*-
+/**
+ * \file binaryio.h
+ * This file is part of LyX, the document processor.
+ * Licence details can be found in the file COPYING.
+ *
+ * Full author contact details are available in file CREDITS.
+ *
+ * Reading and writing of the binary cache files.
+ */
+
+#ifndef LYX_BINARYIO_H
+#define LYX_BINARYIO_H
+
+#include "support/docstring.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace lyx {
+
+namespace support {
+
+class FileName;
+
+/// Write the number \p n in native byte order
+void writeNumber(std::ostream & os, uint64_t n);
+/// Read a number written by writeNumber()
+bool readNumber(std::istream & is, uint64_t & n);
+/// Write the length of \p s, followed by its bytes
+void writeString(std::ostream & os, std::string const & s);
+/// Read a string written by writeString(). This fails if the stream
+/// ends early, e.g. if the file is truncated or corrupt, without
+/// allocating more memory than the data that is actually there.
+bool readString(std::istream & is, std::string & s);
+/// Write \p s in UTF-8
+void writeString(std::ostream & os, docstring const & s);
+///
+bool readString(std::istream & is, docstring & s);
+/// Write the number of strings, followed by the strings in UTF-8
+void writeStrings(std::ostream & os, std::vector<docstring> const & v);
+///
+bool readStrings(std::istream & is, std::vector<docstring> & v);
+
+/**
+ * Replace \p file by a file with \p contents. The contents are written
+ * to a temporary file in the same directory first, which is then moved
+ * to \p file. Thus other processes never read a partially written file.
+ */
+bool replaceFile(FileName const & file, std::string const & contents);
+
+} // namespace support
+} // namespace lyx
+
+#endif
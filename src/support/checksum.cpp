@@ -42,6 +42,14 @@ unsigned long checksum(unsigned char const * beg, unsigned char const * end)
 	return crc32(0, beg, end - beg);
 }
 
+uint64_t checksum64(std::string const & s)
+{
+	auto p = reinterpret_cast<unsigned char const *>(s.c_str());
+	uint64_t const crc = crc32(0, p, s.size());
+	uint64_t const adler = adler32(adler32(0, nullptr, 0), p, s.size());
+	return (crc << 32) | (adler & 0xffffffff);
+}
+
 } // namespace support
 
 } // namespace lyx
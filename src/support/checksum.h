@@ -12,6 +12,7 @@
 #ifndef LYX_CHECKSUM_H
 #define LYX_CHECKSUM_H
 
+#include <cstdint>
 #include <fstream>
 #include <string>
 
@@ -22,6 +23,9 @@ namespace support {
 unsigned long checksum(std::string const & s);
 unsigned long checksum(std::ifstream & ifs);
 unsigned long checksum(unsigned char const * beg, unsigned char const * end);
+/// A 64 bit checksum of \p s, for keys that are unlikely to collide
+/// even over many different contents
+uint64_t checksum64(std::string const & s);
 
 } // namespace support
 
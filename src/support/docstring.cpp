@@ -19,6 +19,7 @@
 
 #include <QFile>
 
+#include <cstdint>
 //Needed in Ubuntu
 #include <typeinfo>
 #if ! defined(USE_WCHAR_T) && defined(__GNUC__)
@@ -241,6 +242,18 @@ lyx::docstring & operator+=(lyx::docstring & l, char r)
 	return l;
 }
 
+
+size_t docstring_hash::operator()(docstring const & s) const
+{
+	// 32 bit FNV-1a over the code points
+	uint32_t h = 2166136261u;
+	for (char_type const c : s) {
+		h ^= uint32_t(c);
+		h *= 16777619u;
+	}
+	return h;
+}
+
 } // namespace lyx
 
 #if ! defined(USE_WCHAR_T) && defined(__GNUC__)
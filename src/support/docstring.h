@@ -91,6 +91,12 @@ docstring & operator+=(docstring &, char const *);
 /// Append a single ASCII character to a docstring
 docstring & operator+=(docstring & l, char r);
 
+/// Hash function object for docstrings, to be used with unordered
+/// containers (std::hash is not specialized for every possible char_type)
+struct docstring_hash {
+	std::size_t operator()(docstring const & s) const;
+};
+
 } // namespace lyx
 
 #endif
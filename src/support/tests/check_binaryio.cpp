@@ -0,0 +1,101 @@
+#include <config.h>
+
+#include "../binaryio.h"
+#include "../checksum.h"
+#include "../docstring.h"
+
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+using namespace lyx;
+using namespace lyx::support;
+
+using namespace std;
+
+void test_roundtrip()
+{
+	docstring const umlauts = from_utf8("\xc3\xa4\xc3\xb6\xc3\xbc");
+	vector<docstring> strings;
+	strings.push_back(from_ascii("a"));
+	strings.push_back(docstring());
+	strings.push_back(umlauts);
+
+	ostringstream os;
+	writeNumber(os, 0);
+	writeNumber(os, numeric_limits<uint64_t>::max());
+	writeString(os, string());
+	writeString(os, string("LyX"));
+	writeString(os, umlauts);
+	writeStrings(os, strings);
+
+	istringstream is(os.str());
+	uint64_t n = 1;
+	cout << readNumber(is, n) << ' ' << n << endl;
+	cout << readNumber(is, n) << ' ' << n << endl;
+	string s = "x";
+	cout << readString(is, s) << " '" << s << "'" << endl;
+	cout << readString(is, s) << " '" << s << "'" << endl;
+	docstring ds;
+	cout << readString(is, ds) << ' ' << (ds == umlauts) << endl;
+	vector<docstring> v;
+	cout << readStrings(is, v) << ' ' << (v == strings) << endl;
+	// at the end
+	cout << readNumber(is, n) << endl;
+}
+
+void test_truncated()
+{
+	ostringstream os;
+	writeString(os, string("something"));
+	string const data = os.str();
+	// cut in the contents, in the length and before the length
+	size_t const lengths[] = { data.size() - 1, 4, 0 };
+	for (size_t len : lengths) {
+		istringstream is(data.substr(0, len));
+		string s;
+		cout << readString(is, s) << endl;
+	}
+
+	ostringstream os2;
+	vector<docstring> strings(2, from_ascii("abc"));
+	writeStrings(os2, strings);
+	string const data2 = os2.str();
+	istringstream is2(data2.substr(0, data2.size() - 1));
+	vector<docstring> v;
+	cout << readStrings(is2, v) << endl;
+}
+
+void test_oversized()
+{
+	// A garbage length must not be trusted
+	ostringstream os;
+	writeNumber(os, uint64_t(1) << 62);
+	os << "abc";
+	istringstream is(os.str());
+	string s;
+	cout << readString(is, s) << endl;
+
+	// The same for the number of strings
+	ostringstream os2;
+	writeNumber(os2, uint64_t(1) << 40);
+	writeString(os2, from_ascii("x"));
+	istringstream is2(os2.str());
+	vector<docstring> v;
+	cout << readStrings(is2, v) << ' ' << v.size() << endl;
+}
+
+void test_checksum64()
+{
+	cout << checksum64(string()) << endl;
+	cout << checksum64("LyX") << endl;
+	cout << (checksum64("ab") != checksum64("ba")) << endl;
+}
+
+int main()
+{
+	test_roundtrip();
+	test_truncated();
+	test_oversized();
+	test_checksum64();
+}